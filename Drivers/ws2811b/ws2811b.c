@@ -26,15 +26,65 @@
 // Reset, end sequence size in pixels. This is a ZERO signal should last for at least 50 uS
 #define reset_pixels 2
 
+#ifdef WS2811B_STATS
+#define WS2811B_COUNT(counter)	(++(counter))
+#else
+#define WS2811B_COUNT(counter)
+#endif
+
 // Forward local functions declarations
+static void WS2811B_initStrip(WS2811B *strip, uint16_t size, TIM_HandleTypeDef *tmr_handle, uint32_t timer_dma_channel, DMA_HandleTypeDef *dma_handle, NEO_TYPE type, const COLOR *palette);
 static void WS2811B_fillDmaBuffer(WS2811B *strip, uint8_t *dma);
 static void WS2811B_initType(WS2811B *strip, NEO_TYPE type);
+static uint8_t WS2811B_divBrightness(WS2811B *strip, uint32_t value);
+static void WS2811B_putPixel(WS2811B *strip, uint16_t n, COLOR c);
+static void WS2811B_putPixelWRGB(WS2811B *strip, uint16_t n, uint8_t white, uint8_t red, uint8_t green, uint8_t blue);
+static void WS2811B_putIndex(WS2811B *strip, uint16_t n, uint8_t index);
+static void WS2811B_colorBytes(WS2811B *strip, uint8_t *pixel, COLOR c);
+static void WS2811B_buildLit(WS2811B *strip);
+static uint16_t WS2811B_rangeLit(WS2811B *strip, uint16_t from, uint16_t to);
+static uint16_t WS2811B_selectLit(WS2811B *strip, uint16_t from, uint16_t to, uint16_t k, uint8_t value);
+static uint16_t WS2811B_selectView(WS2811B *strip, uint16_t k, uint8_t value);
 
 void WS2811B_init(WS2811B *strip, uint16_t size, TIM_HandleTypeDef *tmr_handle, uint32_t timer_dma_channel, DMA_HandleTypeDef *dma_handle, NEO_TYPE type) {
+	WS2811B_initStrip(strip, size, tmr_handle, timer_dma_channel, dma_handle, type, 0);
+}
+
+// Free the buffers, the strip can be initialized again with the other size
+void WS2811B_free(WS2811B *strip) {
+	if (strip->data)
+		WS2811B_waitTransfer(strip);
+	free(strip->data);
+	free(strip->lit);
+	strip->data			= 0;
+	strip->canvas		= 0;
+	strip->lit			= 0;
+	strip->lit_canvas	= 0;
+	strip->lit_count	= 0;
+	strip->leds			= 0;
+	WS2811B_setView(strip, 0);
+}
+
+// The strip working in the indexed mode only, the data array is one byte per LED. The palette should not be zero
+void WS2811B_initIndexed(WS2811B *strip, uint16_t size, TIM_HandleTypeDef *tmr_handle, uint32_t timer_dma_channel, DMA_HandleTypeDef *dma_handle, NEO_TYPE type, const COLOR *palette) {
+	WS2811B_initStrip(strip, size, tmr_handle, timer_dma_channel, dma_handle, type, palette);
+}
+
+static void WS2811B_initStrip(WS2811B *strip, uint16_t size, TIM_HandleTypeDef *tmr_handle, uint32_t timer_dma_channel, DMA_HandleTypeDef *dma_handle, NEO_TYPE type, const COLOR *palette) {
 	WS2811B_initType(strip, type);
 	strip->leds				= 0;
 	strip->data				= 0;
+	strip->canvas			= 0;
+	strip->lit				= 0;
+	strip->lit_canvas		= 0;
+	strip->lit_count		= 0;
+	strip->palette			= palette;
+	strip->palette_shift	= 0;
+	strip->index_only		= (palette != 0);
 	strip->brightness		= 0;							// Do not use brightness, use pure color
+	strip->bright_rcp		= 0;
+	strip->pixel_reads		= 0;
+	strip->pixel_writes		= 0;
 	strip->pwm_zero			= 24; 							// 0.35uS;
 	strip->pwm_one			= 49;							// 0.70uS (59 65)
 	strip->htim				= 0;
@@ -42,13 +92,23 @@ void WS2811B_init(WS2811B *strip, uint16_t size, TIM_HandleTypeDef *tmr_handle,
 	strip->hdma				= 0;
 	strip->ready			= 1;							// Strip is ready for new data and for DMA transfer
 	strip->out_index		= (size + reset_pixels) * strip->bytes_per_led; 	// All the pixels were transferred
-	strip->data = malloc(size * strip->bytes_per_led);
+	uint8_t pixel_bytes = strip->index_only?1:strip->bytes_per_led;
+	strip->data = malloc((size * pixel_bytes + 3) & ~3);	// Whole number of 32-bit words
+	strip->lit	= malloc(((size + 31) >> 5) * sizeof(uint32_t));
+	if (!strip->data || !strip->lit) {
+		free(strip->data);
+		free(strip->lit);
+		strip->data	= 0;
+		strip->lit	= 0;
+	}
+	strip->canvas = strip->data;
 	if (strip->data) {
 		strip->leds 			= size;
 		strip->htim				= tmr_handle;
 		strip->tim_channel		= timer_dma_channel;
 		strip->hdma				= dma_handle;
 	}
+	WS2811B_setView(strip, 0);
 	WS2811B_clear(strip);
 }
 
@@ -93,50 +153,139 @@ COLOR WS2811B_lightWheel(uint8_t wheel_pos) {
 	return WS2811B_color(wheel_pos * 3, 255 - wheel_pos, 255);
 }
 
-void WS2811B_setPixelColor(WS2811B *strip, uint16_t n, COLOR c) {
-	if (n < strip->leds) {
-		uint16_t index = n * strip->bytes_per_led;			// The first index of the pixel in the data buffer
-		while (strip->out_index <= index + strip->bytes_per_led);	// Wait the current pixel transferred to the NEOPIXEL strip
+/*
+ * The HSV to RGB conversion. The hue, saturation and value are 0...255, the hue 0 and 256 are red.
+ * The candidate component values are packed into one word, the hue sector selects the byte of each component
+ * by the shift from the table, so no branch per sector is required.
+ * The rainbow variant is the hexcone model: six sectors, yellow, cyan and magenta are as bright as the primary colors.
+ * The spectrum variant has three sectors as the color wheel: one primary color fades out while the next one rises.
+ */
+static const uint8_t hsv_rainbow[6][3] = {					// The shifts of red, green and blue: v - 0, t - 8, p - 16, q - 24
+	{ 0, 8, 16 }, { 24, 0, 16 }, { 16, 0, 8 }, { 16, 24, 0 }, { 8, 16, 0 }, { 0, 16, 24 }
+};
 
-		uint8_t tmp	= c & 0xFF;								// blue
-		if (strip->brightness)
-			tmp = (tmp * strip->brightness + 128) >> 8;		// '+128' to round the value
-		strip->data[index + strip->b_offset]	= tmp;
-		c >>= 8;
-		tmp	= c & 0xFF;										// green
-		if (strip->brightness)
-			tmp = (tmp * strip->brightness + 128) >> 8;
-		strip->data[index + strip->g_offset]	= tmp;
-		c >>= 8;
-		tmp	= c & 0xFF;										// red
-		if (strip->brightness)
-			tmp = (tmp * strip->brightness + 128) >> 8;
-		strip->data[index + strip->r_offset]	= tmp;
-		if (strip->bytes_per_led > 3) {
-			c >>= 8;
-			tmp	= c & 0xFF;									// white
-			if (strip->brightness)
-				tmp = (tmp * strip->brightness + 128) >> 8;
-			strip->data[index + strip->w_offset]	= tmp;
+static const uint8_t hsv_spectrum[3][3] = {					// The shifts of red, green and blue: base - 0, up - 8, down - 16
+	{ 16, 8, 0 }, { 0, 16, 8 }, { 8, 0, 16 }
+};
+
+static inline uint8_t WS2811B_scale8(uint8_t i, uint8_t scale) {
+	return ((uint16_t)i * ((uint16_t)scale + 1)) >> 8;
+}
+
+// The rainbow color, p is the minimal component value: WS2811B_scale8(val, 255 - sat)
+static inline COLOR WS2811B_hsvRainbow(uint8_t hue, uint8_t sat, uint8_t val, uint8_t p) {
+	uint16_t h6		= (uint16_t)hue * 6;
+	uint8_t  sector	= h6 >> 8;
+	uint8_t  frac	= h6 & 0xFF;
+	uint8_t  q		= WS2811B_scale8(val, 255 - WS2811B_scale8(sat, frac));
+	uint8_t  t		= WS2811B_scale8(val, 255 - WS2811B_scale8(sat, 255 - frac));
+	uint32_t cand	= val | ((uint32_t)t << 8) | ((uint32_t)p << 16) | ((uint32_t)q << 24);
+	const uint8_t *sh = hsv_rainbow[sector];
+	return WS2811B_color(cand >> sh[0], cand >> sh[1], cand >> sh[2]);
+}
+
+COLOR WS2811B_colorHSV(uint8_t hue, uint8_t sat, uint8_t val) {
+	return WS2811B_hsvRainbow(hue, sat, val, WS2811B_scale8(val, 255 - sat));
+}
+
+COLOR WS2811B_colorHSVSpectrum(uint8_t hue, uint8_t sat, uint8_t val) {
+	uint16_t h3		= (uint16_t)hue * 3;
+	uint8_t  sector	= h3 >> 8;
+	uint8_t  frac	= h3 & 0xFF;
+	uint8_t  base	= WS2811B_scale8(val, 255 - sat);
+	uint8_t  amp	= val - base;
+	uint8_t  up		= base + WS2811B_scale8(frac, amp);
+	uint8_t  down	= base + WS2811B_scale8(255 - frac, amp);
+	uint32_t cand	= base | ((uint32_t)up << 8) | ((uint32_t)down << 16);
+	const uint8_t *sh = hsv_spectrum[sector];
+	return WS2811B_color(cand >> sh[0], cand >> sh[1], cand >> sh[2]);
+}
+
+// The number of bytes of the LED in the pixel buffer
+static inline uint8_t WS2811B_pixelBytes(WS2811B *strip) {
+	return strip->palette?1:strip->bytes_per_led;
+}
+
+// The palette color of the index in the indexed mode
+static inline COLOR WS2811B_indexColor(WS2811B *strip, uint8_t index) {
+	return strip->palette[(uint8_t)(index + strip->palette_shift)];
+}
+
+// Translate the pixel index of the view to the position in the view range
+static inline uint16_t WS2811B_viewIndex(WS2811B *strip, uint16_t n) {
+	if (strip->view.flags & VIEW_REVERSE)
+		n = strip->view_pixels - 1 - n;
+	return n;
+}
+
+// The number of bits set. The Cortex-M3 has no such instruction, count the bits in parallel
+static inline uint8_t WS2811B_popcount(uint32_t v) {
+	v = v - ((v >> 1) & 0x55555555);
+	v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+	v = (v + (v >> 4)) & 0x0F0F0F0F;
+	return (v * 0x01010101) >> 24;
+}
+
+// The mask of the bits of the bitmap word w that belong to the LED range [from, to)
+static inline uint32_t WS2811B_rangeMask(uint16_t w, uint16_t from, uint16_t to) {
+	uint32_t mask	= 0xFFFFFFFF;
+	uint32_t first	= (uint32_t)w << 5;
+	if (from > first)
+		mask &= 0xFFFFFFFF << (from - first);
+	if (to < first + 32)
+		mask &= (1UL << (to - first)) - 1;
+	return mask;
+}
+
+// Whether the LED is not black, the pixel points to the first byte of the LED in the buffer
+static inline uint8_t WS2811B_pixelOn(WS2811B *strip, const uint8_t *pixel) {
+	if (strip->palette)
+		return WS2811B_indexColor(strip, *pixel) != 0;
+	uint8_t on = pixel[strip->r_offset] | pixel[strip->g_offset] | pixel[strip->b_offset];
+	if (strip->bytes_per_led > 3)
+		on |= pixel[strip->w_offset];
+	return on;
+}
+
+// Update the bitmap of lit pixels after the LED n has been written
+static inline void WS2811B_markLit(WS2811B *strip, uint16_t n, const uint8_t *pixel) {
+	if (strip->lit_canvas != strip->canvas)
+		return;
+	uint8_t on		= WS2811B_pixelOn(strip, pixel);
+	uint32_t *w		= &strip->lit[n >> 5];
+	uint32_t mask	= 1UL << (n & 31);
+	if (on) {
+		if (!(*w & mask)) {
+			*w |= mask;
+			++strip->lit_count;
 		}
+	} else if (*w & mask) {
+		*w &= ~mask;
+		--strip->lit_count;
+	}
+}
+
+void WS2811B_setPixelColor(WS2811B *strip, uint16_t n, COLOR c) {
+	if (n < strip->view_pixels) {
+		uint16_t p = WS2811B_viewIndex(strip, n);
+		WS2811B_putPixel(strip, strip->view.offset + p, c);
+		if (strip->view.flags & VIEW_MIRROR)
+			WS2811B_putPixel(strip, strip->view.offset + strip->view.length - 1 - p, c);
 	}
 }
 
 void WS2811B_setPixelColorWRGB(WS2811B *strip, uint16_t n, uint8_t white, uint8_t red, uint8_t green, uint8_t blue) {
-	if (n < strip->leds) {
+	if (n < strip->view_pixels) {
 		if (strip->brightness) {
 			white	= (white * strip->brightness + 128) >> 8;
 			red		= (red 	 * strip->brightness + 128) >> 8;
 			green 	= (green * strip->brightness + 128) >> 8;
 			blue 	= (blue  * strip->brightness + 128) >> 8;
 		}
-		uint16_t index = n * strip->bytes_per_led;
-
-		while (strip->out_index <= index + strip->bytes_per_led);	// Wait the current pixel transferred to the NEOPIXEL strip
-		strip->data[index + strip->w_offset]	= white;
-		strip->data[index + strip->r_offset]	= red;
-		strip->data[index + strip->g_offset]	= green;
-		strip->data[index + strip->b_offset]	= blue;
+		uint16_t p = WS2811B_viewIndex(strip, n);
+		WS2811B_putPixelWRGB(strip, strip->view.offset + p, white, red, green, blue);
+		if (strip->view.flags & VIEW_MIRROR)
+			WS2811B_putPixelWRGB(strip, strip->view.offset + strip->view.length - 1 - p, white, red, green, blue);
 	}
 }
 
@@ -144,33 +293,62 @@ void WS2811B_setPixelColorRGB(WS2811B *strip, uint16_t n, uint8_t red, uint8_t g
 	WS2811B_setPixelColorWRGB(strip, n, 0, red, green, blue);
 }
 
+/*
+ * Fill count pixels of the view from the first one with the rainbow colors in one pass.
+ * The hue of the first pixel and the hue step are in 1/256 units, the step can be negative.
+ * The saturation and value are the same for all the pixels, so the minimal component is computed once.
+ * The view is translated once, then the LED position just moves along the strip
+ */
+void WS2811B_fillHSV(WS2811B *strip, uint16_t first, uint16_t count, uint16_t hue, int16_t hue_step, uint8_t sat, uint8_t val) {
+	if (first >= strip->view_pixels || strip->palette)
+		return;
+	if (count > strip->view_pixels - first)
+		count = strip->view_pixels - first;
+	uint8_t  p		= WS2811B_scale8(val, 255 - sat);
+	uint16_t pos	= strip->view.offset + WS2811B_viewIndex(strip, first);
+	int8_t   dir	= (strip->view.flags & VIEW_REVERSE)?-1:1;
+	uint16_t mirror	= (strip->view.offset << 1) + strip->view.length - 1;	// The LED symmetric to pos is mirror - pos
+	uint8_t  twice	= strip->view.flags & VIEW_MIRROR;
+	for (; count > 0; --count) {
+		COLOR c = WS2811B_hsvRainbow(hue >> 8, sat, val, p);
+		WS2811B_putPixel(strip, pos, c);
+		if (twice)
+			WS2811B_putPixel(strip, mirror - pos, c);
+		pos += dir;
+		hue += hue_step;
+	}
+}
+
 
 COLOR WS2811B_getPixelColor(WS2811B *strip, uint16_t n) {
-	if (n >= strip->leds)
+	if (n >= strip->view_pixels)
 		return 0;
+	if (strip->palette)
+		return WS2811B_indexColor(strip, strip->canvas[strip->view.offset + WS2811B_viewIndex(strip, n)]);
 
-	uint16_t index = n * strip->bytes_per_led;
+	WS2811B_COUNT(strip->pixel_reads);
+	uint16_t index = (strip->view.offset + WS2811B_viewIndex(strip, n)) * strip->bytes_per_led;
 	uint32_t c = 0;
 	uint8_t tmp = 0;
 	if (strip->bytes_per_led > 3) {
-		tmp = strip->data[index + strip->w_offset];
+		tmp = strip->canvas[index + strip->w_offset];
 		if (strip->brightness)
-			tmp = ((tmp << 8) + (strip->brightness >> 1)) / strip->brightness;
+			tmp = WS2811B_divBrightness(strip, (tmp << 8) + (strip->brightness >> 1));
 	} else {
 		tmp = 0;
 	}
 	c  	= tmp & 0xFF; c <<= 8;
-	tmp = strip->data[index + strip->r_offset];
+	tmp = strip->canvas[index + strip->r_offset];
 	if (strip->brightness)
-		tmp = ((tmp << 8) + (strip->brightness >> 1)) / strip->brightness;
+		tmp = WS2811B_divBrightness(strip, (tmp << 8) + (strip->brightness >> 1));
 	c  |= tmp & 0xFF; c <<= 8;
-	tmp = strip->data[index + strip->g_offset];
+	tmp = strip->canvas[index + strip->g_offset];
 	if (strip->brightness)
-		tmp = ((tmp << 8) + (strip->brightness >> 1)) / strip->brightness;
+		tmp = WS2811B_divBrightness(strip, (tmp << 8) + (strip->brightness >> 1));
 	c  |= tmp & 0xFF; c <<= 8;
-	tmp = strip->data[index + strip->b_offset];
+	tmp = strip->canvas[index + strip->b_offset];
 	if (strip->brightness)
-		tmp = ((tmp << 8) + (strip->brightness >> 1)) / strip->brightness;
+		tmp = WS2811B_divBrightness(strip, (tmp << 8) + (strip->brightness >> 1));
 	c  |= tmp & 0xFF;
 	return c;
 }
@@ -179,33 +357,261 @@ void WS2811B_setBrightness(WS2811B *strip, uint8_t brightness) {
 	if (brightness == strip->brightness)
 		return;
 	WS2811B_waitTransfer(strip);
+	uint8_t old_brightness = strip->brightness;
+	strip->brightness = brightness;
+	strip->bright_rcp = 0;
+	if (brightness)
+		strip->bright_rcp = ((1UL << 31) + brightness - 1) / brightness;
+	if (strip->palette)										// The palette colors are scaled while the data is transferred
+		return;
 	for (uint16_t i = 0; i < strip->leds * strip->bytes_per_led; ++i) {
 		uint32_t c = strip->data[i];
 		if (c) {
-			if (strip->brightness)
-				c *= strip->brightness;
-			if (brightness) {
-				c += brightness >> 1;
-				c /= brightness;
-			}
+			if (old_brightness)
+				c *= old_brightness;
+			if (brightness)
+				c = WS2811B_divBrightness(strip, c + (brightness >> 1));
 			strip->data[i] = c & 0xFF;
 		}
 	}
-	strip->brightness = brightness;
+	WS2811B_bufferChanged(strip, strip->data);				// The dim component can become zero
 }
 
 uint8_t	WS2811B_getBrightness(WS2811B *strip) {
 	return strip->brightness;
 }
 
+// The number of pixels in the view
 uint16_t WS2811B_numPixels(WS2811B *strip) {
-	return strip->leds;
+	return strip->view_pixels;
 }
 
+// Clear the view range only
 void WS2811B_clear(WS2811B *strip) {
-	WS2811B_waitTransfer(strip);
-	for (uint16_t i = 0; i < strip->leds*strip->bytes_per_led; ++i)
-		strip->data[i] = 0;
+	if (strip->canvas == strip->data)
+		WS2811B_waitTransfer(strip);
+	uint8_t  bytes	= WS2811B_pixelBytes(strip);
+	uint16_t end	= (strip->view.offset + strip->view.length) * bytes;
+	for (uint16_t i = strip->view.offset * bytes; i < end; ++i)
+		strip->canvas[i] = 0;
+	if (strip->palette) {									// The index 0 can be any color
+		WS2811B_bufferChanged(strip, strip->canvas);
+	} else if (strip->lit_canvas == strip->canvas) {
+		uint16_t from	= strip->view.offset;
+		uint16_t to		= strip->view.offset + strip->view.length;
+		for (uint16_t w = from >> 5; (w << 5) < to; ++w) {
+			uint32_t mask = WS2811B_rangeMask(w, from, to);
+			strip->lit_count -= WS2811B_popcount(strip->lit[w] & mask);
+			strip->lit[w] &= ~mask;
+		}
+	}
+}
+
+/*
+ * Fade the view range of the canvas in place. Every byte of the lit LED is scaled by scale/256 (255 means 1.0),
+ * the byte not changed by the scaling is decreased by sub instead, so the dim pixels get black in a few steps.
+ * The sub value is the color decrement, it is scaled by the brightness as the buffer bytes are.
+ * The bytes are changed directly, the black LEDs are skipped by the bitmap of lit pixels,
+ * the LEDs getting black are removed from the bitmap. Returns 1 if the view range is black
+ */
+uint8_t WS2811B_fade(WS2811B *strip, uint8_t scale, uint8_t sub) {
+	if (!strip->lit)
+		return 1;
+	WS2811B_buildLit(strip);
+	uint16_t from	= strip->view.offset;
+	uint16_t to		= strip->view.offset + strip->view.length;
+	if (strip->palette)										// The index can not be faded
+		return WS2811B_rangeLit(strip, from, to) == 0;
+	if (sub && strip->brightness) {							// Zero brightness means the pure colors
+		sub = WS2811B_scale8(sub, strip->brightness);
+		if (!sub) sub = 1;
+	}
+	uint8_t bytes	= strip->bytes_per_led;
+	uint8_t wait	= (strip->canvas == strip->data);
+	for (uint16_t w = from >> 5; (w << 5) < to; ++w) {
+		uint32_t bits = strip->lit[w] & WS2811B_rangeMask(w, from, to);
+		for (uint16_t n = w << 5; bits; bits >>= 1, ++n) {
+			if (!(bits & 0xFF)) {							// Skip 8 black LEDs at once
+				bits >>= 7;
+				n	 += 7;
+				continue;
+			}
+			if (!(bits & 1))
+				continue;
+			uint16_t index	= n * bytes;
+			uint8_t *pixel	= &strip->canvas[index];
+			if (wait)
+				while (strip->out_index <= index + bytes);	// Wait the pixel transferred to the NEOPIXEL strip
+			uint8_t on = 0;
+			for (uint8_t i = 0; i < bytes; ++i) {
+				uint8_t c = pixel[i];
+				uint8_t s = WS2811B_scale8(c, scale);
+				if (s == c)
+					s = (c > sub)?(c - sub):0;
+				pixel[i] = s;
+				on		|= s;
+			}
+			if (!on) {
+				strip->lit[w] &= ~(1UL << (n & 31));
+				--strip->lit_count;
+			}
+		}
+	}
+	return WS2811B_rangeLit(strip, from, to) == 0;
+}
+
+// The size of the pixel buffer in bytes, rounded up to the whole 32-bit words
+uint16_t WS2811B_bufferSize(WS2811B *strip) {
+	uint8_t pixel_bytes = strip->index_only?1:strip->bytes_per_led;
+	return (strip->leds * pixel_bytes + 3) & ~3;
+}
+
+// The number of the buffer bytes per LED in the color mode: 3 or 4
+uint8_t WS2811B_bytesPerLED(WS2811B *strip) {
+	return strip->bytes_per_led;
+}
+
+uint8_t* WS2811B_getData(WS2811B *strip) {
+	return strip->data;
+}
+
+// Draw the pixels in the other buffer instead of the data array. Zero canvas restores the data array
+void WS2811B_setCanvas(WS2811B *strip, uint8_t *canvas) {
+	strip->canvas = canvas?canvas:strip->data;
+}
+
+uint8_t* WS2811B_getCanvas(WS2811B *strip) {
+	return strip->canvas;
+}
+
+// Draw the pixels in the range of the strip. The range is limited by the strip length. Zero view restores the whole strip
+void WS2811B_setView(WS2811B *strip, const PIXEL_SURFACE *view) {
+	strip->view.offset	= 0;
+	strip->view.length	= strip->leds;
+	strip->view.flags	= 0;
+	if (view && view->offset < strip->leds) {
+		strip->view.offset	= view->offset;
+		strip->view.length	= view->length;
+		if (view->offset + view->length > strip->leds)
+			strip->view.length = strip->leds - view->offset;
+		strip->view.flags	= view->flags;
+	}
+	strip->view_pixels = strip->view.length;
+	if (strip->view.flags & VIEW_MIRROR)
+		strip->view_pixels = (strip->view.length + 1) >> 1;
+}
+
+PIXEL_SURFACE WS2811B_getView(WS2811B *strip) {
+	return strip->view;
+}
+
+// Whether the pixel of the view is not black
+uint8_t WS2811B_isLit(WS2811B *strip, uint16_t n) {
+	if (n >= strip->view_pixels)
+		return 0;
+	WS2811B_buildLit(strip);
+	uint16_t p = strip->view.offset + WS2811B_viewIndex(strip, n);
+	return (strip->lit[p >> 5] >> (p & 31)) & 1;
+}
+
+// The number of lit pixels in the view
+uint16_t WS2811B_litPixels(WS2811B *strip) {
+	if (!strip->lit)
+		return 0;
+	WS2811B_buildLit(strip);
+	return WS2811B_rangeLit(strip, strip->view.offset, strip->view.offset + strip->view_pixels);
+}
+
+// Whether all the pixels of the view are black
+uint8_t WS2811B_isDark(WS2811B *strip) {
+	return WS2811B_litPixels(strip) == 0;
+}
+
+// The index of the k-th (starting from 0) lit pixel of the view. Returns WS2811B_numPixels() if there is no such pixel
+uint16_t WS2811B_litPixel(WS2811B *strip, uint16_t k) {
+	return WS2811B_selectView(strip, k, 1);
+}
+
+// The index of the k-th (starting from 0) black pixel of the view. Returns WS2811B_numPixels() if there is no such pixel
+uint16_t WS2811B_unlitPixel(WS2811B *strip, uint16_t k) {
+	return WS2811B_selectView(strip, k, 0);
+}
+
+// The buffer (zero means the data array) was changed directly, the bitmap of lit pixels should be rebuilt
+void WS2811B_bufferChanged(WS2811B *strip, uint8_t *buff) {
+	if (!buff)
+		buff = strip->data;
+	if (strip->lit_canvas == buff)
+		strip->lit_canvas = 0;
+}
+
+/*
+ * Switch the strip to the indexed mode with the 256-color palette, the palette is not copied.
+ * The pixels are cleared to the index 0 when the strip switches from the color mode. The indexed mode
+ * is possible when the pixels are drawn in the data array in whole strip only, so no layer or zone is drawn in colors.
+ * Zero palette switches back to the color mode: the indexes are replaced by the palette colors in place.
+ * Returns 1 if the strip is in the requested mode
+ */
+uint8_t WS2811B_setIndexed(WS2811B *strip, const COLOR *palette) {
+	if (!strip->data)
+		return 0;
+	if (palette) {
+		if (!strip->palette) {
+			if (strip->canvas != strip->data || strip->view.length != strip->leds || strip->view.flags)
+				return 0;
+			WS2811B_waitTransfer(strip);
+			for (uint16_t i = 0; i < strip->leds; ++i)
+				strip->data[i] = 0;
+			strip->palette_shift = 0;
+		}
+		strip->palette = palette;
+		WS2811B_bufferChanged(strip, strip->data);
+		return 1;
+	}
+	if (strip->index_only)
+		return 0;
+	if (strip->palette) {
+		WS2811B_waitTransfer(strip);
+		for (uint16_t n = strip->leds; n > 0; --n) {		// The LED n occupies bytes from n * bytes_per_led, go backward
+			COLOR c			= WS2811B_indexColor(strip, strip->data[n - 1]);
+			uint8_t *pixel	= &strip->data[(n - 1) * strip->bytes_per_led];
+			for (uint8_t i = 0; i < strip->bytes_per_led; ++i)
+				pixel[i] = 0;
+			WS2811B_colorBytes(strip, pixel, c);
+		}
+		strip->palette = 0;
+		WS2811B_bufferChanged(strip, strip->data);
+	}
+	return 1;
+}
+
+uint8_t WS2811B_isIndexed(WS2811B *strip) {
+	return strip->palette != 0;
+}
+
+// Rotate the palette of the indexed mode: all the LEDs change the color at once
+void WS2811B_setPaletteShift(WS2811B *strip, uint8_t shift) {
+	if (!strip->palette || strip->palette_shift == shift)
+		return;
+	WS2811B_waitTransfer(strip);							// Do not change the colors in the middle of the frame
+	strip->palette_shift = shift;
+	WS2811B_bufferChanged(strip, strip->data);
+}
+
+void WS2811B_setPixelIndex(WS2811B *strip, uint16_t n, uint8_t index) {
+	if (strip->palette && n < strip->view_pixels) {
+		uint16_t p = WS2811B_viewIndex(strip, n);
+		WS2811B_putIndex(strip, strip->view.offset + p, index);
+		if (strip->view.flags & VIEW_MIRROR)
+			WS2811B_putIndex(strip, strip->view.offset + strip->view.length - 1 - p, index);
+	}
+}
+
+uint8_t WS2811B_getPixelIndex(WS2811B *strip, uint16_t n) {
+	if (!strip->palette || n >= strip->view_pixels)
+		return 0;
+	WS2811B_COUNT(strip->pixel_reads);
+	return strip->canvas[strip->view.offset + WS2811B_viewIndex(strip, n)];
 }
 
 // Required to be registered as half buffer complete callback procedure
@@ -233,6 +639,17 @@ void WS2811B_waitTransfer(WS2811B *strip) {
 	while (strip->ready == 0);
 }
 
+// The number of the pixel reads and LED writes since the last reset, both are zero without WS2811B_STATS
+void WS2811B_pixelAccess(WS2811B *strip, uint32_t *reads, uint32_t *writes) {
+	*reads	= strip->pixel_reads;
+	*writes	= strip->pixel_writes;
+}
+
+void WS2811B_resetAccess(WS2811B *strip) {
+	strip->pixel_reads	= 0;
+	strip->pixel_writes	= 0;
+}
+
 // This function uses source of HAL_DMA_IRQHandler() built-in function
 void WS2811B_DMA_CallBack(WS2811B *strip) {
 	DMA_HandleTypeDef *hdma = strip->hdma;
@@ -291,13 +708,23 @@ void WS2811B_DMA_CallBack(WS2811B *strip) {
 	  }
 }
 
-// Fill the DMA buffer with PWM values depending on RGB value of the LED. Use out_index to load required data
+/*
+ * Fill the DMA buffer with PWM values depending on RGB value of the LED. Use out_index to load required data.
+ * In the indexed mode the LED color is looked up in the palette, out_index counts the LEDs by bytes_per_led as well
+ */
 static void WS2811B_fillDmaBuffer(WS2811B *strip, uint8_t *dma) {
 	uint16_t index = strip->out_index;
 	if (index < strip->leds * strip->bytes_per_led) {
+		uint8_t pixel[4] = { 0, 0, 0, 0 };
+		const uint8_t *src = &strip->data[index];
+		if (strip->palette) {
+			WS2811B_colorBytes(strip, pixel, WS2811B_indexColor(strip, strip->data[index / strip->bytes_per_led]));
+			src = pixel;
+		}
+		index += strip->bytes_per_led;
 		uint8_t bit = 0;
 		for (uint8_t color = 0; color < strip->bytes_per_led; ++color) {
-			uint8_t c = strip->data[index++];
+			uint8_t c = src[color];
 			for (uint8_t i = 0; i < 8; ++i) {
 				if (c & 0x80) {
 					dma[bit++]	= strip->pwm_one;
@@ -316,6 +743,76 @@ static void WS2811B_fillDmaBuffer(WS2811B *strip, uint8_t *dma) {
 	}
 }
 
+// Write the pixel to the canvas, n is the LED position in the strip. The color is ignored in the indexed mode
+static void WS2811B_putPixel(WS2811B *strip, uint16_t n, COLOR c) {
+	if (strip->palette)
+		return;
+	WS2811B_COUNT(strip->pixel_writes);
+	uint16_t index = n * strip->bytes_per_led;				// The first index of the pixel in the data buffer
+	if (strip->canvas == strip->data)
+		while (strip->out_index <= index + strip->bytes_per_led);	// Wait the current pixel transferred to the NEOPIXEL strip
+
+	WS2811B_colorBytes(strip, &strip->canvas[index], c);
+	WS2811B_markLit(strip, n, &strip->canvas[index]);
+}
+
+// Convert the color to the LED bytes in the output order, the brightness is applied
+static void WS2811B_colorBytes(WS2811B *strip, uint8_t *pixel, COLOR c) {
+	uint8_t tmp	= c & 0xFF;									// blue
+	if (strip->brightness)
+		tmp = (tmp * strip->brightness + 128) >> 8;			// '+128' to round the value
+	pixel[strip->b_offset]	= tmp;
+	c >>= 8;
+	tmp	= c & 0xFF;											// green
+	if (strip->brightness)
+		tmp = (tmp * strip->brightness + 128) >> 8;
+	pixel[strip->g_offset]	= tmp;
+	c >>= 8;
+	tmp	= c & 0xFF;											// red
+	if (strip->brightness)
+		tmp = (tmp * strip->brightness + 128) >> 8;
+	pixel[strip->r_offset]	= tmp;
+	if (strip->bytes_per_led > 3) {
+		c >>= 8;
+		tmp	= c & 0xFF;										// white
+		if (strip->brightness)
+			tmp = (tmp * strip->brightness + 128) >> 8;
+		pixel[strip->w_offset]	= tmp;
+	}
+}
+
+static void WS2811B_putPixelWRGB(WS2811B *strip, uint16_t n, uint8_t white, uint8_t red, uint8_t green, uint8_t blue) {
+	if (strip->palette)
+		return;
+	WS2811B_COUNT(strip->pixel_writes);
+	uint16_t index = n * strip->bytes_per_led;
+
+	if (strip->canvas == strip->data)
+		while (strip->out_index <= index + strip->bytes_per_led);	// Wait the current pixel transferred to the NEOPIXEL strip
+	strip->canvas[index + strip->w_offset]	= white;
+	strip->canvas[index + strip->r_offset]	= red;
+	strip->canvas[index + strip->g_offset]	= green;
+	strip->canvas[index + strip->b_offset]	= blue;
+	WS2811B_markLit(strip, n, &strip->canvas[index]);
+}
+
+// Write the palette index of the LED n in the indexed mode
+static void WS2811B_putIndex(WS2811B *strip, uint16_t n, uint8_t index) {
+	WS2811B_COUNT(strip->pixel_writes);
+	if (strip->canvas == strip->data)
+		while (strip->out_index <= (n + 1) * strip->bytes_per_led);	// Wait the current pixel transferred to the NEOPIXEL strip
+	strip->canvas[n] = index;
+	WS2811B_markLit(strip, n, &strip->canvas[n]);
+}
+
+/*
+ * Divide the value by the brightness without division instruction: value * (2^31/brightness) / 2^31
+ * The reciprocal is rounded up, so the result is exact for all values less than 2^16
+ */
+static uint8_t WS2811B_divBrightness(WS2811B *strip, uint32_t value) {
+	return ((uint64_t)value * strip->bright_rcp) >> 31;
+}
+
 static void WS2811B_initType(WS2811B *strip, NEO_TYPE type) {
 	strip->bytes_per_led	= 3;
 	uint32_t type_code = type;
@@ -327,3 +824,86 @@ static void WS2811B_initType(WS2811B *strip, NEO_TYPE type) {
 		strip->bytes_per_led	= 4;
 	}
 }
+
+// Rebuild the bitmap of lit pixels from the canvas, if the bitmap describes other buffer
+static void WS2811B_buildLit(WS2811B *strip) {
+	if (strip->lit_canvas == strip->canvas)
+		return;
+	uint16_t words = (strip->leds + 31) >> 5;
+	for (uint16_t w = 0; w < words; ++w)
+		strip->lit[w] = 0;
+	uint16_t count		= 0;
+	uint8_t  bytes		= WS2811B_pixelBytes(strip);
+	const uint8_t *c	= strip->canvas;
+	for (uint16_t n = 0; n < strip->leds; ++n, c += bytes) {
+		if (WS2811B_pixelOn(strip, c)) {
+			strip->lit[n >> 5] |= 1UL << (n & 31);
+			++count;
+		}
+	}
+	strip->lit_count	= count;
+	strip->lit_canvas	= strip->canvas;
+}
+
+// The number of lit pixels in the LED range [from, to)
+static uint16_t WS2811B_rangeLit(WS2811B *strip, uint16_t from, uint16_t to) {
+	if (from == 0 && to == strip->leds)
+		return strip->lit_count;
+	uint16_t count = 0;
+	for (uint16_t w = from >> 5; (w << 5) < to; ++w)
+		count += WS2811B_popcount(strip->lit[w] & WS2811B_rangeMask(w, from, to));
+	return count;
+}
+
+/*
+ * The LED of the k-th (starting from 0) lit (value = 1) or black (value = 0) pixel in the range [from, to).
+ * Skip whole words by the number of bits set, then skip the bytes of the word. Returns to if there is no such pixel
+ */
+static uint16_t WS2811B_selectLit(WS2811B *strip, uint16_t from, uint16_t to, uint16_t k, uint8_t value) {
+	for (uint16_t w = from >> 5; (w << 5) < to; ++w) {
+		uint32_t bits = strip->lit[w];
+		if (!value)
+			bits = ~bits;
+		bits &= WS2811B_rangeMask(w, from, to);
+		uint8_t count = WS2811B_popcount(bits);
+		if (k >= count) {
+			k -= count;
+			continue;
+		}
+		uint16_t n = w << 5;
+		for (count = WS2811B_popcount(bits & 0xFF); k >= count; count = WS2811B_popcount(bits & 0xFF)) {
+			k -= count;
+			bits >>= 8;
+			n += 8;
+		}
+		for (;; bits >>= 1, ++n) {
+			if (bits & 1) {
+				if (k == 0)
+					return n;
+				--k;
+			}
+		}
+	}
+	return to;
+}
+
+// The view index of the k-th lit (value = 1) or black (value = 0) pixel of the view
+static uint16_t WS2811B_selectView(WS2811B *strip, uint16_t k, uint8_t value) {
+	if (!strip->lit)
+		return strip->view_pixels;
+	WS2811B_buildLit(strip);
+	uint16_t from	= strip->view.offset;
+	uint16_t to		= strip->view.offset + strip->view_pixels;
+	if (strip->view.flags & VIEW_REVERSE) {					// Count the pixels from the end of the range
+		uint16_t count = WS2811B_rangeLit(strip, from, to);
+		if (!value)
+			count = strip->view_pixels - count;
+		if (k >= count)
+			return strip->view_pixels;
+		k = count - 1 - k;
+	}
+	uint16_t p = WS2811B_selectLit(strip, from, to, k, value);
+	if (p >= to)
+		return strip->view_pixels;
+	return WS2811B_viewIndex(strip, p - from);
+}
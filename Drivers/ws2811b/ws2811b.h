@@ -9,6 +9,23 @@
  * Data array is allocated dynamically as continuous array of bytes of size N*3, where N is the number of LEDs in neopixel strip.
  * Data is transfered to neopixel strip bit-by-bit in the following order: G7,G6,G5,...G0,R7,R6,...R0,B7,B6,...B0.
  * That is why the data array has the color order G-R-B.
+ * The pixels can be drawn in the other buffer of the same size (canvas), see WS2811B_setCanvas().
+ * The canvas buffer should be allocated with WS2811B_bufferSize() bytes. The data array size is rounded up
+ * to 32-bit words as well, so the whole buffers can be processed word by word.
+ * The pixels are addressed through the view (PIXEL_SURFACE), see WS2811B_setView(). The view is a range of the strip,
+ * that can be reversed or mirrored. The pixel index is translated to the strip position, no data is copied.
+ * By default the view covers the whole strip.
+ * The driver keeps the bitmap of lit pixels (one bit per LED) and the number of lit pixels of the canvas,
+ * they are updated by every pixel write. So the queries: whether the view is dark, how many pixels are lit
+ * and where is the k-th lit or unlit pixel, do not read the pixel colors. The bitmap is rebuilt from the canvas
+ * when the canvas is changed. If the buffer was written directly, not by the pixel functions,
+ * call WS2811B_bufferChanged() to rebuild the bitmap on the next query.
+ * If WS2811B_STATS is defined, the driver counts the pixel reads and writes, see WS2811B_pixelAccess().
+ * In the indexed mode (see WS2811B_setIndexed()) the data array keeps one byte per LED: the index of the color
+ * in the 256-color palette. The colors are looked up while the data is transferred to the strip, so
+ * the colors of the whole strip are rotated by WS2811B_setPaletteShift() without rewriting the pixels.
+ * The pixels are written by WS2811B_setPixelIndex() in this mode, the color writes are ignored.
+ * The strip initialized by WS2811B_initIndexed() allocates one byte per LED and always works in the indexed mode.
  */
 
 #ifdef __cplusplus
@@ -40,39 +57,89 @@ typedef enum e_neo_type	NEO_TYPE;
 
 #define DMA_BUFF_SIZE	64									// two pixels, 32-bit color (in case of WRGB neopixel)
 
+enum e_view_flags {
+	VIEW_REVERSE	= 0x01,									// The first pixel of the view is the last one of the range
+	VIEW_MIRROR		= 0x02									// The pixel is drawn twice: in the first half of the range and symmetric one
+};
+
+struct s_PIXEL_SURFACE {
+	uint16_t			offset;								// The first LED of the range
+	uint16_t			length;								// The number of LEDs in the range
+	uint8_t				flags;								// VIEW_REVERSE, VIEW_MIRROR
+};
+typedef struct s_PIXEL_SURFACE PIXEL_SURFACE;
+
 struct s_WS2811B {
 	TIM_HandleTypeDef	*htim;								// Pointer to the timer handler
 	uint32_t			tim_channel;						// DMA channel of the timer
 	DMA_HandleTypeDef 	*hdma;								// DMA handler
 	uint8_t				dma[DMA_BUFF_SIZE];					// DMA buffer to be transferred to PWM timer
 	uint8_t 			*data;								// Array of pixel's components [GRB]
+	uint8_t				*canvas;							// The buffer to draw the pixels in, usually the data array
+	uint32_t			*lit;								// The bitmap of lit pixels of the lit_canvas
+	uint8_t				*lit_canvas;						// The buffer described by the lit bitmap, 0 if the bitmap is not valid
+	uint16_t			lit_count;							// The number of lit pixels in the lit_canvas
+	const COLOR			*palette;							// The palette of the indexed mode, 0 in the color mode
+	uint8_t				palette_shift;						// The palette rotation: the color of index i is palette[i + shift]
+	uint8_t				index_only;							// The data array is allocated for the indexed mode only
 	uint16_t			leds;								// The numbed of LEDs in the strip
+	PIXEL_SURFACE		view;								// The range of the strip to draw the pixels in
+	uint16_t			view_pixels;						// The number of pixels in the view (half of the range if mirrored)
 	uint8_t				pwm_zero, pwm_one;					// Timer period for zero and one
 	uint8_t				brightness;							// The LED brightness
+	uint32_t			bright_rcp;							// The reciprocal of the brightness: 2^31/brightness, rounded up
 	uint8_t				r_offset, g_offset, b_offset;		// The RGB offsets in the output sequence
 	uint8_t				w_offset;							// The white offset in the output sequence (if applicable)
 	uint8_t				bytes_per_led;						// 3 or 4
+	uint32_t			pixel_reads;						// The number of pixel reads (WS2811B_STATS)
+	uint32_t			pixel_writes;						// The number of LED writes (WS2811B_STATS)
 	volatile uint16_t 	out_index;							// The index of the current displayed pixel from the data buffer
 	volatile uint8_t	ready;								// The flag indicating that no DMA transfer is in progress
 };
 typedef struct s_WS2811B WS2811B;
 
 void		WS2811B_init(WS2811B *strip, uint16_t size, TIM_HandleTypeDef *tmr_handle, uint32_t timer_dma_channel, DMA_HandleTypeDef *dma_handle, NEO_TYPE type);
+void		WS2811B_free(WS2811B *strip);
+void		WS2811B_initIndexed(WS2811B *strip, uint16_t size, TIM_HandleTypeDef *tmr_handle, uint32_t timer_dma_channel, DMA_HandleTypeDef *dma_handle, NEO_TYPE type, const COLOR *palette);
 COLOR		WS2811B_color(uint8_t red, uint8_t green, uint8_t blue);
 COLOR		WS2811B_colorW(uint8_t white, uint8_t red, uint8_t green, uint8_t blue);
 COLOR		WS2811B_wheel(uint8_t wheel_pos);
 COLOR		WS2811B_lightWheel(uint8_t wheel_pos);
+COLOR		WS2811B_colorHSV(uint8_t hue, uint8_t sat, uint8_t val);
+COLOR		WS2811B_colorHSVSpectrum(uint8_t hue, uint8_t sat, uint8_t val);
 void 		WS2811B_setPixelColorRGB(WS2811B *strip, uint16_t n, uint8_t red, uint8_t green, uint8_t blue);
 void 		WS2811B_setPixelColorWRGB(WS2811B *strip, uint16_t n, uint8_t white, uint8_t red, uint8_t green, uint8_t blue);
 void 		WS2811B_setPixelColor(WS2811B *strip, uint16_t n, COLOR c);
+void		WS2811B_fillHSV(WS2811B *strip, uint16_t first, uint16_t count, uint16_t hue, int16_t hue_step, uint8_t sat, uint8_t val);
 COLOR 		WS2811B_getPixelColor(WS2811B *strip, uint16_t n);
 void		WS2811B_setBrightness(WS2811B *strip, uint8_t brightness);
 uint8_t		WS2811B_getBrightness(WS2811B *strip);
 void 		WS2811B_show(WS2811B *strip);
 void 		WS2811B_clear(WS2811B *strip);
+uint8_t		WS2811B_fade(WS2811B *strip, uint8_t scale, uint8_t sub);
 uint16_t	WS2811B_numPixels(WS2811B *strip);
+uint16_t	WS2811B_bufferSize(WS2811B *strip);
+uint8_t		WS2811B_bytesPerLED(WS2811B *strip);
+uint8_t*	WS2811B_getData(WS2811B *strip);
+void		WS2811B_setCanvas(WS2811B *strip, uint8_t *canvas);
+uint8_t*	WS2811B_getCanvas(WS2811B *strip);
+void		WS2811B_setView(WS2811B *strip, const PIXEL_SURFACE *view);
+PIXEL_SURFACE WS2811B_getView(WS2811B *strip);
+uint8_t		WS2811B_isLit(WS2811B *strip, uint16_t n);
+uint16_t	WS2811B_litPixels(WS2811B *strip);
+uint8_t		WS2811B_isDark(WS2811B *strip);
+uint16_t	WS2811B_litPixel(WS2811B *strip, uint16_t k);
+uint16_t	WS2811B_unlitPixel(WS2811B *strip, uint16_t k);
+void		WS2811B_bufferChanged(WS2811B *strip, uint8_t *buff);
+uint8_t		WS2811B_setIndexed(WS2811B *strip, const COLOR *palette);
+uint8_t		WS2811B_isIndexed(WS2811B *strip);
+void		WS2811B_setPaletteShift(WS2811B *strip, uint8_t shift);
+void		WS2811B_setPixelIndex(WS2811B *strip, uint16_t n, uint8_t index);
+uint8_t		WS2811B_getPixelIndex(WS2811B *strip, uint16_t n);
 void 		WS2811B_DMA_CallBack(WS2811B *strip);
 void		WS2811B_waitTransfer(WS2811B *strip);
+void		WS2811B_pixelAccess(WS2811B *strip, uint32_t *reads, uint32_t *writes);
+void		WS2811B_resetAccess(WS2811B *strip);
 
 #ifdef __cplusplus
 }
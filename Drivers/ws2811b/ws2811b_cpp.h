@@ -1,6 +1,7 @@
 #ifndef __WS2811B_CPP_H
 #define __WS2811B_CPP_H
 #include "ws2811b.h"
+#include "ws2811b_wheel.h"
 
 class NEOPIXEL {
 	public:
@@ -8,14 +9,26 @@ class NEOPIXEL {
 		void		init(uint16_t size, TIM_HandleTypeDef *tmr_handle, uint32_t timer_dma_channel, DMA_HandleTypeDef *dma_handle, NEO_TYPE type = NEO_GRB) {
 			WS2811B_init(&s, size, tmr_handle, timer_dma_channel, dma_handle, type);
 		}
+		void		release(void) {
+			WS2811B_free(&s);
+		}
+		void		initIndexed(uint16_t size, TIM_HandleTypeDef *tmr_handle, uint32_t timer_dma_channel, DMA_HandleTypeDef *dma_handle, const COLOR *palette, NEO_TYPE type = NEO_GRB) {
+			WS2811B_initIndexed(&s, size, tmr_handle, timer_dma_channel, dma_handle, type, palette);
+		}
 		COLOR 		Color(uint8_t red, uint8_t green, uint8_t blue, uint8_t white = 0) {
 			return WS2811B_colorW(white, red, green, blue);
 		}
+		COLOR		ColorHSV(uint8_t hue, uint8_t sat = 255, uint8_t val = 255) {
+			return WS2811B_colorHSV(hue, sat, val);
+		}
+		COLOR		ColorHSVSpectrum(uint8_t hue, uint8_t sat = 255, uint8_t val = 255) {
+			return WS2811B_colorHSVSpectrum(hue, sat, val);
+		}
 		COLOR		wheel(uint8_t wheel_pos) {
-			return WS2811B_wheel(wheel_pos);
+			return wheelLUT()[wheel_pos];					// The same color as WS2811B_wheel(wheel_pos)
 		}
 		COLOR		lightWheel(uint8_t wheel_pos) {
-			return WS2811B_lightWheel(wheel_pos);
+			return lightWheelLUT()[wheel_pos];				// The same color as WS2811B_lightWheel(wheel_pos)
 		}
 		void 		setPixelColor(uint16_t n, uint8_t red, uint8_t green, uint8_t blue, uint8_t white = 0) {
 			WS2811B_setPixelColorWRGB(&s, n, white, red, green, blue);
@@ -23,6 +36,9 @@ class NEOPIXEL {
 		void 		setPixelColor(uint16_t n, COLOR c) {
 			WS2811B_setPixelColor(&s, n, c);
 		}
+		void		fillHSV(uint16_t first, uint16_t count, uint16_t hue, int16_t hue_step, uint8_t sat = 255, uint8_t val = 255) {
+			WS2811B_fillHSV(&s, first, count, hue, hue_step, sat, val);
+		}
 		COLOR 		getPixelColor(uint16_t n) {
 			return WS2811B_getPixelColor(&s, n);
 		}
@@ -38,15 +54,87 @@ class NEOPIXEL {
 		void 		clear(void) {
 			WS2811B_clear(&s);
 		}
+		bool		fade(uint8_t scale, uint8_t sub) {
+			return WS2811B_fade(&s, scale, sub);
+		}
+		bool		fadeToBlackBy(uint8_t amount) {						// Scale by (255 - amount), like FastLED
+			return WS2811B_fade(&s, 255 - amount, 0);
+		}
+		bool		scaleAll(uint8_t scale) {							// nscale8() of every pixel
+			return WS2811B_fade(&s, scale, 0);
+		}
+		bool		subtractAll(uint8_t val) {
+			return WS2811B_fade(&s, 255, val);
+		}
 		uint16_t	numPixels(void) {
 			return WS2811B_numPixels(&s);
 		}
+		uint16_t	bufferSize(void) {
+			return WS2811B_bufferSize(&s);
+		}
+		uint8_t		bytesPerLED(void) {
+			return WS2811B_bytesPerLED(&s);
+		}
+		uint8_t*	getData(void) {
+			return WS2811B_getData(&s);
+		}
+		void		setCanvas(uint8_t *canvas) {
+			WS2811B_setCanvas(&s, canvas);
+		}
+		uint8_t*	getCanvas(void) {
+			return WS2811B_getCanvas(&s);
+		}
+		void		setView(const PIXEL_SURFACE *view) {
+			WS2811B_setView(&s, view);
+		}
+		PIXEL_SURFACE getView(void) {
+			return WS2811B_getView(&s);
+		}
+		bool		isLit(uint16_t n) {
+			return WS2811B_isLit(&s, n);
+		}
+		uint16_t	litPixels(void) {
+			return WS2811B_litPixels(&s);
+		}
+		bool		isDark(void) {
+			return WS2811B_isDark(&s);
+		}
+		uint16_t	litPixel(uint16_t k) {
+			return WS2811B_litPixel(&s, k);
+		}
+		uint16_t	unlitPixel(uint16_t k) {
+			return WS2811B_unlitPixel(&s, k);
+		}
+		void		bufferChanged(uint8_t *buff = 0) {
+			WS2811B_bufferChanged(&s, buff);
+		}
+		bool		setIndexed(const COLOR *palette) {
+			return WS2811B_setIndexed(&s, palette);
+		}
+		bool		isIndexed(void) {
+			return WS2811B_isIndexed(&s);
+		}
+		void		setPaletteShift(uint8_t shift) {
+			WS2811B_setPaletteShift(&s, shift);
+		}
+		void		setPixelIndex(uint16_t n, uint8_t index) {
+			WS2811B_setPixelIndex(&s, n, index);
+		}
+		uint8_t		getPixelIndex(uint16_t n) {
+			return WS2811B_getPixelIndex(&s, n);
+		}
 		void 		DMA_CallBack(void) {
 			WS2811B_DMA_CallBack(&s);
 		}
 		void		waitTransfer(void) {
 			WS2811B_waitTransfer(&s);
 		}
+		void		pixelAccess(uint32_t &reads, uint32_t &writes) {
+			WS2811B_pixelAccess(&s, &reads, &writes);
+		}
+		void		resetAccess(void) {
+			WS2811B_resetAccess(&s);
+		}
 	private:
 		WS2811B	s;
 };
@@ -0,0 +1,60 @@
+#ifndef __WS2811B_WHEEL_H
+#define __WS2811B_WHEEL_H
+#include "ws2811b.h"
+
+/*
+ * Color wheel lookup tables, generated by the compiler.
+ * The generator repeats WS2811B_wheel() and WS2811B_lightWheel() step-by-step, so the table contains
+ * exactly the same colors as these functions return. The tables are constant initialized, so they are placed
+ * in the flash memory and no run-time initialization is required.
+ */
+
+class WHEEL_LUT {
+	public:
+		constexpr WHEEL_LUT(bool light) : clr() {
+			for (uint16_t i = 0; i < 256; ++i)
+				clr[i] = light?lightWheel(i):wheel(i);
+		}
+		COLOR		operator[](uint8_t wheel_pos) const		{ return clr[wheel_pos]; }
+		const COLOR* table(void) const						{ return clr; }
+	private:
+		static constexpr COLOR color(uint8_t red, uint8_t green, uint8_t blue) {
+			return (COLOR(red) << 16) | (COLOR(green) << 8) | blue;
+		}
+		static constexpr COLOR wheel(uint8_t wheel_pos) {
+			wheel_pos = 255 - wheel_pos;
+			if (wheel_pos < 85)
+				return color(255 - wheel_pos * 3, 0, wheel_pos * 3);
+			if (wheel_pos < 170) {
+				wheel_pos -= 85;
+				return color(0, wheel_pos * 3, 255 - wheel_pos * 3);
+			}
+			wheel_pos -= 170;
+			return color(wheel_pos * 3, 255 - wheel_pos * 3, 0);
+		}
+		static constexpr COLOR lightWheel(uint8_t wheel_pos) {
+			wheel_pos = 255 - wheel_pos;
+			if (wheel_pos < 85)
+				return color(255 - wheel_pos, 255, wheel_pos * 3);
+			if (wheel_pos < 170) {
+				wheel_pos -= 85;
+				return color(255, wheel_pos * 3, 255 - wheel_pos);
+			}
+			wheel_pos -= 170;
+			return color(wheel_pos * 3, 255 - wheel_pos, 255);
+		}
+		COLOR		clr[256];
+};
+
+// The tables are local static constants of inline functions to have single copy of each one in the flash
+inline const WHEEL_LUT& wheelLUT(void) {
+	static constexpr WHEEL_LUT lut(false);
+	return lut;
+}
+
+inline const WHEEL_LUT& lightWheelLUT(void) {
+	static constexpr WHEEL_LUT lut(true);
+	return lut;
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __HAL_SIM_H
+#define __HAL_SIM_H
+#include "stm32f1xx_hal.h"
+
+/*
+ * The peripheral emulation of the host build.
+ * The time is simulated: HAL_GetTick() returns the simulated milliseconds, HAL_Delay() and the DMA transfers
+ * advance the time, the main loop advances it by sim_advance(). So the animations run faster than real time.
+ * The timer/DMA emulator decodes the PWM compare values written by the ws2811b driver back to the bits,
+ * one PWM period (1.25 us) per bit, and calls DMA1_Channel5_IRQHandler() on the half and complete transfer
+ * as the hardware does. The transfer is completed inside HAL_TIM_PWM_Start_DMA(), so WS2811B_show() returns
+ * when the frame is out. The decoded bytes in the output order (G-R-B for NEO_GRB) make up the captured frame,
+ * the frame hook is called when the timer is stopped.
+ * The ADC returns the light value set by sim_setLight(), setup() seeds the random generator with it.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*SIM_FRAME_HOOK)(const uint8_t *bytes, uint16_t size, uint32_t tick);
+
+void			sim_advance(uint32_t us);
+uint64_t		sim_nanos(void);
+void			sim_setLight(uint16_t light);
+void			sim_setFrameHook(SIM_FRAME_HOOK hook);
+uint32_t		sim_frames(void);
+const uint8_t*	sim_lastFrame(uint16_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef __STM32F1xx_HAL_H
+#define __STM32F1xx_HAL_H
+/*
+ * The host replacement of the STM32F1 HAL: the types, constants and functions used by the project only.
+ * The peripherals are emulated in hal_sim.c, see hal_sim.h
+ */
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { RESET = 0, SET = !RESET }						FlagStatus, ITStatus;
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT }	HAL_StatusTypeDef;
+typedef enum { HAL_UNLOCKED = 0, HAL_LOCKED }					HAL_LockTypeDef;
+#define UNUSED(X)	(void)X											// As stm32f1xx_hal_def.h does
+
+//---------------------------------------------- GPIO ---------------------------------------------------------------------
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET }				GPIO_PinState;
+typedef struct {
+	volatile uint32_t	IDR, ODR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef		sim_gpioa, sim_gpiob;
+#define GPIOA			(&sim_gpioa)
+#define GPIOB			(&sim_gpiob)
+#define GPIO_PIN_0		((uint16_t)0x0001)
+#define GPIO_PIN_1		((uint16_t)0x0002)
+#define GPIO_PIN_3		((uint16_t)0x0008)
+#define GPIO_PIN_4		((uint16_t)0x0010)
+#define EXTI1_IRQn		7
+#define EXTI3_IRQn		9
+#define __HAL_GPIO_EXTI_GET_IT(pin)		(RESET)
+#define __HAL_GPIO_EXTI_CLEAR_IT(pin)	((void)(pin))
+
+//---------------------------------------------- DMA ----------------------------------------------------------------------
+typedef struct {
+	volatile uint32_t	ISR, IFCR;
+} DMA_TypeDef;
+
+typedef struct {
+	volatile uint32_t	CCR, CNDTR, CPAR, CMAR;
+} DMA_Channel_TypeDef;
+
+typedef enum {
+	HAL_DMA_STATE_RESET = 0, HAL_DMA_STATE_READY, HAL_DMA_STATE_BUSY, HAL_DMA_STATE_TIMEOUT
+} HAL_DMA_StateTypeDef;
+
+typedef enum {
+	HAL_DMA_XFER_CPLT_CB_ID = 0, HAL_DMA_XFER_HALFCPLT_CB_ID, HAL_DMA_XFER_ERROR_CB_ID, HAL_DMA_XFER_ABORT_CB_ID
+} HAL_DMA_CallbackIDTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+	DMA_Channel_TypeDef		*Instance;
+	HAL_LockTypeDef			Lock;
+	HAL_DMA_StateTypeDef	State;
+	void					*Parent;
+	void					(*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+	void					(*XferHalfCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+	void					(*XferErrorCallback)(struct __DMA_HandleTypeDef *hdma);
+	void					(*XferAbortCallback)(struct __DMA_HandleTypeDef *hdma);
+	volatile uint32_t		ErrorCode;
+	DMA_TypeDef				*DmaBaseAddress;
+	uint32_t				ChannelIndex;
+} DMA_HandleTypeDef;
+
+#define DMA_FLAG_GL1		((uint32_t)0x00000001)
+#define DMA_FLAG_TC1		((uint32_t)0x00000002)
+#define DMA_FLAG_HT1		((uint32_t)0x00000004)
+#define DMA_FLAG_TE1		((uint32_t)0x00000008)
+#define DMA_ISR_GIF1		DMA_FLAG_GL1
+#define DMA_IT_TC			((uint32_t)0x00000002)
+#define DMA_IT_HT			((uint32_t)0x00000004)
+#define DMA_IT_TE			((uint32_t)0x00000008)
+#define HAL_DMA_ERROR_TE	((uint32_t)0x00000001)
+
+#define __HAL_DMA_GET_TC_FLAG_INDEX(h)	(DMA_FLAG_TC1 << (h)->ChannelIndex)
+#define __HAL_DMA_GET_HT_FLAG_INDEX(h)	(DMA_FLAG_HT1 << (h)->ChannelIndex)
+#define __HAL_DMA_CLEAR_FLAG(h, flag)	((h)->DmaBaseAddress->ISR &= ~(flag))
+#define __HAL_DMA_DISABLE_IT(h, it)		((h)->Instance->CCR &= ~(it))
+#define __HAL_DMA_ENABLE_IT(h, it)		((h)->Instance->CCR |= (it))
+#define __HAL_UNLOCK(h)					do { (h)->Lock = HAL_UNLOCKED; } while (0)
+
+HAL_StatusTypeDef	HAL_DMA_RegisterCallback(DMA_HandleTypeDef *hdma, HAL_DMA_CallbackIDTypeDef id, void (*cb)(DMA_HandleTypeDef *hdma));
+
+//---------------------------------------------- Timer --------------------------------------------------------------------
+typedef struct {
+	volatile uint32_t	ARR, CCR1;
+} TIM_TypeDef;
+
+typedef struct {
+	TIM_TypeDef			*Instance;
+	DMA_HandleTypeDef	*hdma[7];
+} TIM_HandleTypeDef;
+
+#define TIM_CHANNEL_1		((uint32_t)0x00000000)
+
+HAL_StatusTypeDef	HAL_TIM_PWM_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel, uint32_t *pData, uint16_t Length);
+HAL_StatusTypeDef	HAL_TIM_PWM_Stop_DMA(TIM_HandleTypeDef *htim, uint32_t Channel);
+
+//---------------------------------------------- ADC ----------------------------------------------------------------------
+typedef struct {
+	volatile uint32_t	SR, CR1, CR2, SQR1, DR;
+} ADC_TypeDef;
+
+typedef struct {
+	ADC_TypeDef			*Instance;
+} ADC_HandleTypeDef;
+
+typedef struct {
+	uint32_t			Channel, Rank, SamplingTime;
+} ADC_ChannelConfTypeDef;
+
+#define ADC_CHANNEL_3				((uint32_t)0x00000003)
+#define ADC_SAMPLETIME_1CYCLE_5		((uint32_t)0x00000000)
+#define ADC_SAMPLETIME_7CYCLES_5	((uint32_t)0x00000001)
+#define ADC_CR1_SCAN				((uint32_t)0x00000100)
+#define ADC_SQR1_L					((uint32_t)0x00F00000)
+#define ADC_FLAG_EOC				((uint32_t)0x00000002)
+#define HAL_IS_BIT_CLR(REG, BIT)	(((REG) & (BIT)) == 0U)
+
+HAL_StatusTypeDef	HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig);
+HAL_StatusTypeDef	HAL_ADC_Start(ADC_HandleTypeDef *hadc);
+uint32_t			HAL_ADC_GetValue(ADC_HandleTypeDef *hadc);
+
+//---------------------------------------------- SPI ----------------------------------------------------------------------
+typedef struct {
+	uint32_t			Init;
+} SPI_HandleTypeDef;
+
+HAL_StatusTypeDef	HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+//---------------------------------------------- System -------------------------------------------------------------------
+uint32_t			HAL_GetTick(void);
+void				HAL_Delay(uint32_t Delay);
+GPIO_PinState		HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void				HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
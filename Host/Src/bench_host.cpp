@@ -0,0 +1,20 @@
+#include "bench.h"
+#include <stdio.h>
+#include <time.h>
+
+//---------------------------------------------- The host platform: the monotonic clock in nanoseconds and stdout ------
+void benchClockStart(void) { }
+
+uint32_t benchCycles(void) {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return uint32_t(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+uint32_t benchCyclesPerUs(void) {
+	return 1000;
+}
+
+void benchPrint(const char *line) {
+	puts(line);
+}
@@ -0,0 +1,78 @@
+/*
+ * The host benchmark of the animations and the drawing primitives, see bench.h. The CSV report goes to stdout.
+ * Usage: bench [-n frames] [-l length,length,...] [-a] [-k]
+ *	-n	the number of steps to measure (200 by default)
+ *	-l	the strip lengths (100,300,1000,5000,10000 by default), up to 10000
+ *	-a	the animations only
+ *	-k	the drawing primitives only
+ * The times are the host times, they show the relative cost. Build the target with BENCHMARK for the real numbers.
+ */
+
+#include "hal_sim.h"
+#include "start.h"
+#include "bench.h"
+#include "tree3d.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+extern TIM_HandleTypeDef	htim2;
+extern DMA_HandleTypeDef	hdma_tim2_ch1;
+
+static const uint16_t		max_leds	= 10000;
+
+// The spiral tree of the strip length, the other length gets the part of the longer spiral
+static void treeInit(uint16_t leds) {
+	static const TREE_SPIRAL<100, 8>		*t100	= new TREE_SPIRAL<100, 8>;
+	static const TREE_SPIRAL<300, 8>		*t300	= new TREE_SPIRAL<300, 8>;
+	static const TREE_SPIRAL<1000, 8>		*t1000	= new TREE_SPIRAL<1000, 8>;
+	static const TREE_SPIRAL<5000, 8>		*t5000	= new TREE_SPIRAL<5000, 8>;
+	static const TREE_SPIRAL<max_leds, 8>	*tmax	= new TREE_SPIRAL<max_leds, 8>;
+	const LED_POS *map = tmax->map();
+	if (leds <= 100)		map = t100->map();
+	else if (leds <= 300)	map = t300->map();
+	else if (leds <= 1000)	map = t1000->map();
+	else if (leds <= 5000)	map = t5000->map();
+	tree.init(map, leds);
+}
+
+int main(int argc, char *argv[]) {
+	uint16_t	frames		= 200;
+	uint16_t	lengths[8]	= { 100, 300, 1000, 5000, 10000 };
+	uint8_t		num_len		= 5;
+	bool		do_anims	= true;
+	bool		do_kernels	= true;
+	int opt;
+	while ((opt = getopt(argc, argv, "n:l:ak")) != -1) {
+		switch (opt) {
+			case 'n': frames = strtoul(optarg, 0, 0); break;
+			case 'l':
+				num_len = 0;
+				for (char *p = optarg; *p && num_len < 8; ) {
+					uint32_t leds = strtoul(p, &p, 0);
+					if (leds > 0 && leds <= max_leds)
+						lengths[num_len++] = leds;
+					if (*p == ',') ++p;
+					else break;
+				}
+				break;
+			case 'a': do_kernels	= false; break;
+			case 'k': do_anims		= false; break;
+			default:
+				fprintf(stderr, "Usage: %s [-n frames] [-l length,length,...] [-a] [-k]\n", argv[0]);
+				return 2;
+		}
+	}
+
+	BENCH bench;
+	if (!bench.init(frames)) return 1;
+	bench.header();
+	for (uint8_t l = 0; l < num_len; ++l) {
+		strip.release();
+		strip.init(lengths[l], &htim2, TIM_CHANNEL_1, &hdma_tim2_ch1, NEO_GRB);
+		treeInit(lengths[l]);
+		if (do_anims)	bench.animations(anims, num_anim);
+		if (do_kernels)	bench.kernels();
+	}
+	return 0;
+}
@@ -0,0 +1,500 @@
+/*
+ * The host checks of the optimized helpers against the code they replaced: the lookup tables, the packed color
+ * arithmetic, the incremental formulas. Every check runs over all the inputs or over the random ones
+ * and reports the first mismatch.
+ * Usage: check [-b] [name ...]
+ *	-b		time the old code and the new one on the same inputs instead of checking (host nanoseconds per call)
+ *	name	run the named checks only, all of them by default
+ */
+
+#include "hal_sim.h"
+#include "ws2811b_cpp.h"
+#include "clrmath.h"
+#include "clrutils.h"
+#include "animation.h"
+#include "tools.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern TIM_HandleTypeDef	htim2;
+extern DMA_HandleTypeDef	hdma_tim2_ch1;
+
+static const uint32_t	num_random	= 1000000;					// The number of random inputs of the check
+static const uint32_t	num_timed	= 1000000;					// The number of calls timed
+static volatile COLOR	sink;										// Keeps the results of the timed calls
+
+// The random component: the edge values are more probable
+static uint8_t randByte(void) {
+	static const uint8_t edge[] = { 0, 1, 2, 127, 128, 129, 253, 254, 255 };
+	if (rand() & 3) return rand() & 0xFF;
+	return edge[rand() % sizeof(edge)];
+}
+
+static COLOR randColor(void) {
+	return (COLOR(randByte()) << 24) | (COLOR(randByte()) << 16) | (COLOR(randByte()) << 8) | randByte();
+}
+
+static uint8_t comp(COLOR c, uint8_t i) {
+	return (c >> (i << 3)) & 0xFF;
+}
+
+static COLOR rgb(uint8_t r, uint8_t g, uint8_t b) {
+	return (COLOR(r) << 16) | (COLOR(g) << 8) | b;
+}
+
+//---------------------------------------------- The old per-component code --------------------------------------------------
+static COLOR oldBlendAdd(COLOR color1, COLOR color2) {
+	uint8_t r1 = color1 >> 16, g1 = color1 >> 8, b1 = color1;
+	uint8_t r2 = color2 >> 16, g2 = color2 >> 8, b2 = color2;
+	return rgb(constrain(r1+r2, 0, 255), constrain(g1+g2, 0, 255), constrain(b1+b2, 0, 255));
+}
+
+static COLOR oldBlendSub(COLOR color1, COLOR color2) {
+	uint8_t r1 = color1 >> 16, g1 = color1 >> 8, b1 = color1;
+	uint8_t r2 = color2 >> 16, g2 = color2 >> 8, b2 = color2;
+	int16_t r = int16_t(r1) - r2, g = int16_t(g1) - g2, b = int16_t(b1) - b2;
+	if (r < 0) r = 0;
+	if (g < 0) g = 0;
+	if (b < 0) b = 0;
+	return rgb(r, g, b);
+}
+
+static COLOR oldTwoAdd(COLOR c1, COLOR c2) {
+	COLOR c = 0;
+	for (uint8_t i = 0; i < 3; ++i) {
+		uint32_t p = c1 >> (i*8);
+		p += c2 >> (i*8);
+		p &= 0xff;
+		p <<= i*8;
+		c |= p;
+	}
+	return c;
+}
+
+static bool oldChangeClr(COLOR& c, int8_t val, COLOR preset) {
+	COLOR	new_color	= 0;
+	uint8_t	bound		= 0;
+	if (val < 0) {
+		if (c == 0) return true;
+		int16_t e = 256 + val;
+		for (uint8_t i = 0; i < 3; ++i) {
+			int32_t cc = c & 0xff; c >>= 8;
+			int32_t new_cc = cc * e; new_cc >>= 8;
+			if (new_cc == cc) cc += val; else cc = new_cc;
+			if (cc <= 0) {
+				cc = 0;
+				++bound;
+			}
+			new_color >>= 8;
+			cc <<= 16; new_color |= cc;
+		}
+	} else {
+		for (uint8_t i = 0; i < 3; ++i) {
+			uint8_t  pc = comp(preset, i);
+			int16_t  e  = (pc * val) >> 8;
+			if (e == 0) e = 1;
+			int32_t cc = c & 0xff; c >>= 8;
+			cc += e;
+			if (cc >= pc) {
+				cc = pc;
+				++bound;
+			}
+			new_color >>= 8;
+			cc <<= 16; new_color |= cc;
+		}
+	}
+	c = new_color;
+	return (bound >= 3);
+}
+
+// The old WAVE::intencity(): every component is multiplied by the amplitude 0...254 and divided by 254
+static COLOR oldIntencity(COLOR c, uint8_t amp) {
+	COLOR res = 0;
+	for (uint8_t i = 0; i < 3; ++i) {
+		res >>= 8;
+		uint32_t cc = c & 0xFF;	c >>= 8;
+		cc *= amp;
+		cc /= 254;
+		cc <<= 16; res |= cc;
+	}
+	return res;
+}
+
+// The old scaling of the component by the fraction of 255
+static COLOR oldScale(COLOR c, uint8_t scale) {
+	COLOR res = 0;
+	for (uint8_t i = 0; i < 4; ++i)
+		res |= COLOR(comp(c, i) * scale / 255) << (i << 3);
+	return res;
+}
+
+// The packed function against the per-component reference on the random inputs
+template <typename PACKED, typename REF>
+static bool checkPacked(const char *name, PACKED packed, REF ref) {
+	for (uint32_t n = 0; n < num_random; ++n) {
+		COLOR a = randColor(), b = randColor();
+		COLOR r = 0;
+		for (uint8_t i = 0; i < 4; ++i)
+			r |= COLOR(ref(comp(a, i), comp(b, i)) & 0xFF) << (i << 3);
+		COLOR p = packed(a, b);
+		if (p != r) {
+			printf("%s(%08lx, %08lx) is %08lx, expected %08lx\n", name, (unsigned long)a, (unsigned long)b,
+					(unsigned long)p, (unsigned long)r);
+			return false;
+		}
+	}
+	return true;
+}
+
+// The new helper against the old one on the random inputs
+template <typename NEW, typename OLD>
+static bool checkSame(const char *name, NEW fnew, OLD fold) {
+	for (uint32_t n = 0; n < num_random; ++n) {
+		COLOR a = randColor() & 0xFFFFFF, b = randColor() & 0xFFFFFF;
+		COLOR r = fnew(a, b), e = fold(a, b);
+		if (r != e) {
+			printf("%s(%06lx, %06lx) is %06lx, expected %06lx\n", name, (unsigned long)a, (unsigned long)b,
+					(unsigned long)r, (unsigned long)e);
+			return false;
+		}
+	}
+	return true;
+}
+
+//---------------------------------------------- The checks ----------------------------------------------------------------
+// The wheel tables generated by the compiler give the same colors as the driver functions
+static bool checkWheel(void) {
+	for (uint16_t i = 0; i < 256; ++i) {
+		if (wheelLUT()[i] != WS2811B_wheel(i)) {
+			printf("wheel(%u) is %06lx, expected %06lx\n", i, (unsigned long)wheelLUT()[i], (unsigned long)WS2811B_wheel(i));
+			return false;
+		}
+		if (lightWheelLUT()[i] != WS2811B_lightWheel(i)) {
+			printf("lightWheel(%u) is %06lx, expected %06lx\n", i,
+					(unsigned long)lightWheelLUT()[i], (unsigned long)WS2811B_lightWheel(i));
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * Time the old function and the new one on the same random inputs, print nanoseconds per call.
+ * The functions are inlined in the loop both, so the call overhead is not measured
+ */
+template <typename NEW, typename OLD>
+static void timeSame(const char *name, NEW fnew, OLD fold) {
+	COLOR *in = (COLOR *)malloc(num_timed * 2 * sizeof(COLOR));
+	if (!in) return;
+	for (uint32_t n = 0; n < num_timed * 2; ++n)
+		in[n] = randColor() & 0xFFFFFF;
+	COLOR	 acc	= 0;
+	uint32_t start	= benchCycles();
+	for (uint32_t n = 0; n < num_timed; ++n)
+		acc ^= fold(in[n << 1], in[(n << 1) + 1]);
+	uint32_t t_old	= benchCycles() - start;
+	start			= benchCycles();
+	for (uint32_t n = 0; n < num_timed; ++n)
+		acc ^= fnew(in[n << 1], in[(n << 1) + 1]);
+	uint32_t t_new	= benchCycles() - start;
+	sink = acc;
+	free(in);
+	double per_call = 1000.0 / benchCyclesPerUs() / num_timed;
+	printf("%-14s old %6.2f ns, new %6.2f ns per call\n", name, t_old * per_call, t_new * per_call);
+}
+
+// The packed color arithmetic against the component-by-component code
+static bool checkClrmath(void) {
+	return checkPacked("clrAdd",		clrAdd,		[](int a, int b) { return (a + b > 255)?255:a + b; })
+		&& checkPacked("clrAddWrap",	clrAddWrap,	[](int a, int b) { return a + b; })
+		&& checkPacked("clrSub",		clrSub,		[](int a, int b) { return (a > b)?a - b:0; })
+		&& checkPacked("clrLess",		clrLess,	[](int a, int b) { return (a < b)?255:0; })
+		&& checkPacked("clrEqual",		clrEqual,	[](int a, int b) { return (a == b)?255:0; })
+		&& checkPacked("clrMin",		clrMin,		[](int a, int b) { return (a < b)?a:b; })
+		&& checkPacked("clrMax",		clrMax,		[](int a, int b) { return (a > b)?a:b; })
+		&& checkPacked("clrMul",		clrMul,		[](int a, int b) { return (a * (b + 1)) >> 8; })
+;
+}
+
+// The scaling and the interpolation by the factor 0...256 of every component value, the other components are random
+static bool checkScale(void) {
+	for (uint16_t f = 0; f <= 256; ++f) {
+		for (uint16_t v = 0; v < 256; ++v) {
+			COLOR a = (randColor() & 0xFFFFFF00) | v, b = randColor();
+			COLOR s = clrScale(a, f), l = clrLerp(a, b, f);
+			for (uint8_t i = 0; i < 4; ++i) {
+				uint8_t es = (comp(a, i) * f) >> 8;
+				uint8_t el = (comp(a, i) * (256 - f) + comp(b, i) * f) >> 8;
+				if (comp(s, i) != es || comp(l, i) != el) {
+					printf("clrScale/clrLerp(%08lx, %08lx, %u) is %08lx/%08lx, the component %u expected %02x/%02x\n",
+							(unsigned long)a, (unsigned long)b, f, (unsigned long)s, (unsigned long)l, i, es, el);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// BRGTN, BLEND and TWOCLR helpers against their old code
+class BRGTN_CHECK : public BRGTN {
+	public:
+		bool	check(void);
+};
+
+bool BRGTN_CHECK::check(void) {
+	for (uint32_t n = 0; n < num_random; ++n) {
+		COLOR	preset	= randColor() & 0xFFFFFF;
+		COLOR	c		= randColor() & 0xFFFFFF;
+		int8_t	val		= int8_t(rand());
+		if (val > 0) c = clrMin(c, preset);							// The increment starts below the preset color
+		setColor(preset);
+		COLOR	cn		= c, co = c;
+		bool	dn		= changeClr(cn, val);
+		bool	od		= oldChangeClr(co, val, preset);
+		if (cn != co || dn != od) {
+			printf("changeClr(%06lx, %d) to %06lx is %06lx %u, expected %06lx %u\n", (unsigned long)c, val,
+					(unsigned long)preset, (unsigned long)cn, dn, (unsigned long)co, od);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void timeHelpers(void) {
+	BLEND		blend;
+	TWOCLR		two;
+	BRGTN		brgtn;
+	timeSame("BLEND::add",	[&blend](COLOR a, COLOR b) { return blend.add(a, b); },	oldBlendAdd);
+	timeSame("BLEND::sub",	[&blend](COLOR a, COLOR b) { return blend.sub(a, b); },	oldBlendSub);
+	timeSame("TWOCLR::add",	[&two](COLOR a, COLOR b) { return two.add(a, b); },		oldTwoAdd);
+	timeSame("changeClr",	[&brgtn](COLOR a, COLOR b) { brgtn.changeClr(a, -int8_t(b & 0x3F) - 1); return a; },
+							[](COLOR a, COLOR b) { oldChangeClr(a, -int8_t(b & 0x3F) - 1, 0); return a; });
+}
+
+static bool checkHelpers(void) {
+	BLEND		blend;
+	TWOCLR		two;
+	BRGTN_CHECK	brgtn;
+	return checkSame("BLEND::add",	[&blend](COLOR a, COLOR b) { return blend.add(a, b); },	oldBlendAdd)
+		&& checkSame("BLEND::sub",	[&blend](COLOR a, COLOR b) { return blend.sub(a, b); },	oldBlendSub)
+		&& checkSame("TWOCLR::add",	[&two](COLOR a, COLOR b) { return two.add(a, b); },		oldTwoAdd)
+		&& brgtn.check();
+}
+
+/*
+ * The scale8 family against the division by 255: the result is within 1 LSB of the old floor(i * scale / 255),
+ * scale 255 keeps the value, the video variants never switch the lit component off.
+ * The packed variants give the same components as the single ones
+ */
+static bool checkScale8(void) {
+	for (uint16_t scale = 0; scale < 256; ++scale) {
+		for (uint16_t i = 0; i < 256; ++i) {
+			int old = i * scale / 255;
+			int s	= scale8(i, scale);
+			int v	= scale8_video(i, scale);
+			if (abs(s - old) > 1 || abs(v - old) > 1 || (scale == 255 && s != i) || ((i && scale) != (v != 0))) {
+				printf("scale8/scale8_video(%u, %u) is %d/%d, the division gives %d\n", i, scale, s, v, old);
+				return false;
+			}
+			COLOR c = (randColor() & 0xFFFFFF00) | i;
+			COLOR n = nscale8(c, scale), nv = nscale8_video(c, scale);
+			for (uint8_t k = 0; k < 4; ++k) {
+				if (comp(n, k) != scale8(comp(c, k), scale) || comp(nv, k) != scale8_video(comp(c, k), scale)) {
+					printf("nscale8/nscale8_video(%08lx, %u) is %08lx/%08lx\n", (unsigned long)c, scale,
+							(unsigned long)n, (unsigned long)nv);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// WAVE::intencity() is within 1 LSB of the old code for every component value and phase
+static bool checkIntencity(void) {
+	WAVE wave;
+	for (uint16_t n = 0; n < 256; ++n) {
+		uint8_t amp = wave.amplitude(n);
+		for (uint16_t v = 0; v < 256; ++v) {
+			COLOR c	  = rgb(v, randByte(), randByte());
+			COLOR r	  = wave.intencity(c, n);
+			COLOR old = oldIntencity(c, amp);
+			for (uint8_t k = 0; k < 3; ++k) {
+				if (abs(int(comp(r, k)) - int(comp(old, k))) > 1) {
+					printf("intencity(%06lx, %u) is %06lx, expected %06lx\n", (unsigned long)c, n,
+							(unsigned long)r, (unsigned long)old);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+/*
+ * The driver divides by the brightness through the reciprocal. Both the pixel read and the brightness change
+ * give exactly the same bytes as the old division for every brightness and every byte value
+ */
+static bool checkBrightness(void) {
+	WS2811B s;
+	WS2811B_init(&s, 256, &htim2, TIM_CHANNEL_1, &hdma_tim2_ch1, NEO_RGB);
+	if (!s.data) return false;
+	bool ok = true;
+	for (uint16_t from = 0; from < 256 && ok; ++from) {
+		WS2811B_setBrightness(&s, 0);
+		memset(s.data, 0, 256 * 3);
+		WS2811B_setBrightness(&s, from);
+		for (uint16_t i = 0; i < 256; ++i)					// The pixel i has the byte value i in all the components
+			memset(&s.data[i * 3], i, 3);
+		WS2811B_bufferChanged(&s, s.data);
+		for (uint16_t i = 0; from && i < 256; ++i) {
+			uint8_t e = ((i << 8) + (from >> 1)) / from;
+			if (WS2811B_getPixelColor(&s, i) != rgb(e, e, e)) {
+				printf("getPixelColor() of the byte %u at the brightness %u is %06lx, expected %02x\n", i, from,
+						(unsigned long)WS2811B_getPixelColor(&s, i), e);
+				ok = false;
+				break;
+			}
+		}
+		uint8_t to = rand() & 0xFF;
+		if (to == from) ++to;
+		WS2811B_setBrightness(&s, to);
+		for (uint16_t i = 0; ok && i < 256; ++i) {
+			uint32_t c = i;
+			if (c) {
+				if (from) c *= from;
+				if (to) c = (c + (to >> 1)) / to;
+			}
+			if (s.data[i * 3] != (c & 0xFF)) {
+				printf("setBrightness() from %u to %u of the byte %u is %u, expected %lu\n", from, to, i,
+						s.data[i * 3], (unsigned long)(c & 0xFF));
+				ok = false;
+			}
+		}
+	}
+	WS2811B_free(&s);
+	return ok;
+}
+
+static void timeScale8(void) {
+	WAVE wave;
+	timeSame("nscale8",		[](COLOR a, COLOR b) { return nscale8(a, b); },			oldScale);
+	timeSame("intencity",	[&wave](COLOR a, COLOR b) { return wave.intencity(a, b); },
+							[&wave](COLOR a, COLOR b) { return oldIntencity(a, wave.amplitude(b)); });
+	const uint8_t	br	= 77;										// The reciprocal is computed once by setBrightness()
+	const uint32_t	rcp	= ((1UL << 31) + br - 1) / br;
+	timeSame("brightness",	[rcp](COLOR a, COLOR) { return COLOR(((uint64_t)(((a & 0xFF) << 8) + (br >> 1)) * rcp) >> 31); },
+							[](COLOR a, COLOR) { return COLOR((((a & 0xFF) << 8) + (br >> 1)) / br); });
+}
+
+static void timeWheel(void) {
+	timeSame("wheel",		[](COLOR a, COLOR) { return wheelLUT()[a & 0xFF]; },
+							[](COLOR a, COLOR) { return WS2811B_wheel(a); });
+}
+
+/*
+ * interfer::show() steps the wave phase along the strip. Every frame is compared with the old formula:
+ * the phase is the wave age minus the distance to the source, modulo 64
+ */
+class INTERFER_CHECK : public interfer {
+	public:
+		bool	check(uint16_t frames);
+	private:
+		COLOR	direct(int p, uint8_t source);
+};
+
+COLOR INTERFER_CHECK::direct(int p, uint8_t source) {
+	int e = tm - start[source] - abs(p - pos[source]);
+	if (e < 0) return 0;											// The wave is not here yet
+	e %= 64;
+	uint8_t elm = (e < 32)?(31 - e) << 3:(e - 32) << 3;
+	COLOR	c	= strip.wheel(w[source]), r = 0;
+	for (uint8_t k = 0; k < 3; ++k) {
+		int v = comp(c, k) - elm;
+		if (v > 0) r |= COLOR(v) << (k << 3);
+	}
+	return r;
+}
+
+bool INTERFER_CHECK::check(uint16_t frames) {
+	uint16_t n = strip.numPixels();
+	COLOR	*expected = (COLOR *)malloc(n * sizeof(COLOR));
+	if (!expected) return false;
+	bool ok = true;
+	init();
+	for (uint16_t f = 0; f < frames && ok; ++f) {
+		for (uint16_t i = 0; i < n; ++i) {							// The sources as they are before the frame
+			COLOR c = 0;
+			for (uint8_t j = 0; j < active; ++j)
+				c = oldTwoAdd(c, direct(i, j));
+			expected[i] = c;
+		}
+		show();
+		for (uint16_t i = 0; i < n; ++i) {
+			if (strip.getPixelColor(i) != expected[i]) {
+				printf("interfer on %u pixels, frame %u, pixel %u is %06lx, expected %06lx\n", n, f, i,
+						(unsigned long)strip.getPixelColor(i), (unsigned long)expected[i]);
+				ok = false;
+				break;
+			}
+		}
+	}
+	free(expected);
+	return ok;
+}
+
+static bool checkInterfer(void) {
+	static const uint16_t lengths[] = { 100, 300, 1000 };
+	bool ok = true;
+	for (uint8_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]) && ok; ++l) {
+		strip.release();
+		strip.init(lengths[l], &htim2, TIM_CHANNEL_1, &hdma_tim2_ch1, NEO_RGB);
+		INTERFER_CHECK inter;
+		ok = inter.check(10000);
+	}
+	strip.release();
+	return ok;
+}
+
+static const struct {
+	const char	*name;
+	bool		(*run)(void);
+	void		(*time)(void);										// The benchmark of the old code and the new one, if any
+} checks[] = {
+	{ "wheel",		checkWheel,		timeWheel	},
+	{ "clrmath",	checkClrmath,	0			},
+	{ "scale",		checkScale,		0			},
+	{ "helpers",	checkHelpers,	timeHelpers	},
+	{ "scale8",		checkScale8,	timeScale8	},
+	{ "intencity",	checkIntencity,	0			},
+	{ "brightness",	checkBrightness,0			},
+	{ "interfer",	checkInterfer,	0			},
+};
+
+int main(int argc, char *argv[]) {
+	uint8_t	 num	= sizeof(checks) / sizeof(checks[0]);
+	uint16_t failed	= 0, done = 0;
+	bool	 timing	= (argc > 1 && strcmp(argv[1], "-b") == 0);
+	int		 first	= timing?2:1;
+	for (uint8_t i = 0; i < num; ++i) {
+		bool selected = (argc <= first);
+		for (int a = first; a < argc; ++a)
+			if (strcmp(argv[a], checks[i].name) == 0) selected = true;
+		if (!selected) continue;
+		srand(1);
+		if (timing) {
+			if (checks[i].time) checks[i].time();
+			continue;
+		}
+		bool ok = checks[i].run();
+		printf("%s: %s\n", checks[i].name, ok?"ok":"FAILED");
+		failed += !ok;
+		++done;
+	}
+	if (!timing)
+		printf("%u checks, %u failed\n", done, failed);
+	return failed?1:0;
+}
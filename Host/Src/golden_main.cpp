@@ -0,0 +1,333 @@
+/*
+ * The golden frame regression test: every animation, every clearance and the manager run from the fixed random seed
+ * for the fixed number of steps, each transferred frame is hashed (FNV-1a) and compared with the hashes recorded before.
+ * The first diverging frame of the case is reported. The record run writes the frames to the reference file as well,
+ * so the check can show the first diverging pixel when the reference file is at hand (it is too large to keep in git).
+ * Usage: golden [-u] [-n steps] [-s seed] [-r reference] hash_file
+ *	-u	record the hash file and the reference file instead of checking
+ *	-n	the number of steps per case when recording (100 by default), the manager case runs 5 times longer
+ *	-s	the random seed when recording (1 by default). The check uses the steps and the seed of the hash file
+ *	-r	the reference frames file
+ * The cases: anim.N is anims[N], clear.N is clearance[N] (see start.cpp), manager is setup() and loop() of the project.
+ * The case starts with the empty strip (clear.N - with the rainbow), srand(seed), the palette off, the shortest step period.
+ */
+
+#include "hal_sim.h"
+#include "start.h"
+#include "animation.h"
+#include "clean.h"
+#include "tree3d.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern TIM_HandleTypeDef	htim2;
+extern DMA_HandleTypeDef	hdma_tim2_ch1;
+
+static const uint16_t		golden_leds	= 100;
+static const uint8_t		mgr_factor	= 5;						// The manager case runs longer to reach the clearance and the next animation
+
+//---------------------------------------------- The frame hashes of one case ----------------------------------------------
+class GOLDEN {
+	public:
+		GOLDEN(void)											{ }
+		bool		init(bool record, uint16_t max_frames, FILE *hash_file, FILE *ref_file);
+		void		begin(const char *case_name);
+		void		frame(const uint8_t *bytes, uint16_t size);
+		bool		end(void);
+		uint16_t	count(void)									{ return num; }
+	private:
+		bool		loadCase(void);
+		void		pixelDiff(const uint8_t *bytes, uint16_t size);
+		static uint32_t	hash(const uint8_t *bytes, uint16_t size);
+		bool		record		= false;
+		FILE		*gold		= 0;
+		FILE		*ref		= 0;
+		uint16_t	max_frames	= 0;
+		uint32_t	*hashes		= 0;							// The hashes of the current run
+		uint32_t	*expected	= 0;							// The golden hashes of the case
+		uint16_t	num			= 0;							// The number of frames of the current run
+		uint16_t	num_exp		= 0;							// The number of golden frames
+		uint8_t		*frames		= 0;							// The frames: recorded or loaded from the reference file
+		uint16_t	frame_size	= 0;							// The frame size, bytes
+		uint16_t	ref_num		= 0;							// The number of the reference frames loaded
+		int32_t		diverged	= -1;							// The first diverging frame or -1
+		char		name[32];
+		char		diff[128];									// The first diverging pixel description
+};
+
+static GOLDEN	golden;
+
+bool GOLDEN::init(bool rec, uint16_t max_f, FILE *hash_file, FILE *ref_file) {
+	record		= rec;
+	gold		= hash_file;
+	ref			= ref_file;
+	max_frames	= max_f;
+	hashes		= (uint32_t *)malloc(max_frames * sizeof(uint32_t));
+	expected	= (uint32_t *)malloc(max_frames * sizeof(uint32_t));
+	return hashes && expected;
+}
+
+// FNV-1a, 32 bits
+uint32_t GOLDEN::hash(const uint8_t *bytes, uint16_t size) {
+	uint32_t h = 2166136261UL;
+	for (uint16_t i = 0; i < size; ++i) {
+		h ^= bytes[i];
+		h *= 16777619UL;
+	}
+	return h;
+}
+
+void GOLDEN::begin(const char *case_name) {
+	strncpy(name, case_name, sizeof(name) - 1);
+	name[sizeof(name) - 1] = '\0';
+	num			= 0;
+	num_exp		= 0;
+	ref_num		= 0;
+	diverged	= -1;
+	diff[0]		= '\0';
+	if (!record) loadCase();
+}
+
+// Read the golden hashes of the case and its reference frames, if any
+bool GOLDEN::loadCase(void) {
+	char	 n[32];
+	unsigned c;
+	if (fscanf(gold, "%31s %u", n, &c) != 2 || strcmp(n, name) != 0 || c > max_frames) {
+		fprintf(stderr, "%s: no golden hashes, record the hash file again\n", name);
+		return false;
+	}
+	for (unsigned f = 0; f < c; ++f) {
+		unsigned h;
+		if (fscanf(gold, "%x", &h) != 1) return false;
+		expected[f] = h;
+	}
+	num_exp = c;
+	if (!ref) return true;
+
+	uint8_t head[4];
+	if (fread(head, 1, sizeof(head), ref) != sizeof(head)) {
+		ref = 0;
+		return true;
+	}
+	uint16_t rn = head[0] | (head[1] << 8);
+	uint16_t rs = head[2] | (head[3] << 8);
+	if (rn > max_frames || rs != frame_size) {
+		free(frames);
+		frames		= (uint8_t *)malloc(uint32_t(max_frames) * rs);
+		frame_size	= frames?rs:0;
+	}
+	if (!frames || fread(frames, rs, rn, ref) != rn) {
+		ref = 0;
+		return true;
+	}
+	ref_num = rn;
+	return true;
+}
+
+void GOLDEN::frame(const uint8_t *bytes, uint16_t size) {
+	if (num >= max_frames) return;
+	uint32_t h = hash(bytes, size);
+	if (record) {
+		if (size != frame_size) {								// The frame size is the same for all the cases
+			free(frames);
+			frames		= (uint8_t *)malloc(uint32_t(max_frames) * size);
+			frame_size	= frames?size:0;
+		}
+		if (frames) memcpy(&frames[uint32_t(num) * size], bytes, size);
+	} else if (diverged < 0 && (num >= num_exp || h != expected[num])) {
+		diverged = num;
+		if (num < num_exp) pixelDiff(bytes, size);
+	}
+	hashes[num++] = h;
+}
+
+// Compare the frame with the reference one. The reference file is checked against the golden hash first
+void GOLDEN::pixelDiff(const uint8_t *bytes, uint16_t size) {
+	if (num >= ref_num || size != frame_size) return;
+	const uint8_t *r = &frames[uint32_t(num) * size];
+	if (hash(r, size) != expected[num]) return;					// The reference file is from another record
+	uint8_t bpl = strip.bytesPerLED();
+	for (uint16_t i = 0; i < size; ++i) {
+		if (bytes[i] != r[i]) {
+			uint16_t p = i / bpl;
+			char act[12], want[12];
+			for (uint8_t b = 0; b < bpl; ++b) {
+				snprintf(&act[b << 1], 3, "%02x", bytes[p * bpl + b]);
+				snprintf(&want[b << 1], 3, "%02x", r[p * bpl + b]);
+			}
+			snprintf(diff, sizeof(diff), ", pixel %u is %s, expected %s (the output byte order)", p, act, want);
+			return;
+		}
+	}
+}
+
+// Finish the case: write the record or report the divergence. Returns false if the case differs
+bool GOLDEN::end(void) {
+	if (record) {
+		fprintf(gold, "%s %u", name, num);
+		for (uint16_t f = 0; f < num; ++f)
+			fprintf(gold, "%s%08lx", (f % 16 == 0)?"\n":" ", (unsigned long)hashes[f]);
+		fprintf(gold, "\n");
+		if (ref && frames) {
+			uint8_t head[4] = { uint8_t(num), uint8_t(num >> 8), uint8_t(frame_size), uint8_t(frame_size >> 8) };
+			fwrite(head, 1, sizeof(head), ref);
+			fwrite(frames, frame_size, num, ref);
+		}
+		return true;
+	}
+	if (diverged < 0 && num < num_exp)
+		diverged = num;
+	if (diverged < 0) return true;
+	if (diverged >= num_exp || diverged >= num)
+		printf("%s: %u frames, expected %u\n", name, num, num_exp);
+	else
+		printf("%s: frame %ld of %u differs%s\n", name, (long)diverged, num, diff[0]?diff:" (no reference frames to find the pixel)");
+	return false;
+}
+
+static void goldenFrame(const uint8_t *bytes, uint16_t size, uint32_t) {
+	golden.frame(bytes, size);
+}
+
+//---------------------------------------------- The test cases ------------------------------------------------------------
+static void animCase(uint8_t i, uint32_t seed, uint16_t steps) {
+	char n[16];
+	snprintf(n, sizeof(n), "anim.%u", i);
+	golden.begin(n);
+	animation *an = anims[i];
+	srand(seed);
+	an->setPalette(0);
+	strip.setIndexed(0);
+	strip.clear();
+	an->init();
+	an->do_clear	= false;
+	an->resetTime();
+	uint16_t period	= uint16_t(an->min_p) * 10 + 1;
+	uint32_t ms		= 0;
+	for (uint16_t s = 0; s < steps; ++s) {
+		if (an->do_clear) {										// The manager would clear the strip and start again
+			strip.setIndexed(0);
+			strip.clear();
+			an->init();
+			an->do_clear = false;
+			an->resetTime();
+		}
+		ms += period;
+		an->advance(ms, period);
+		strip.show();
+	}
+}
+
+static void clearCase(uint8_t i, uint32_t seed, uint16_t steps) {
+	char n[16];
+	snprintf(n, sizeof(n), "clear.%u", i);
+	golden.begin(n);
+	clr *c = clearance[i];
+	srand(seed);
+	strip.setIndexed(0);
+	uint16_t leds = strip.numPixels();
+	for (uint16_t p = 0; p < leds; ++p)
+		strip.setPixelColor(p, strip.wheel(uint32_t(p) * 256 / leds));
+	c->init();
+	for (uint16_t s = 0; s < steps && !c->isComplete(); ++s) {
+		c->show();
+		strip.show();
+	}
+}
+
+// The whole project as it runs on the target: the animation sequence, the clearances, the crossfades
+static void managerCase(uint32_t seed, uint16_t frames) {
+	golden.begin("manager");
+	strip.release();
+	sim_setLight(seed);
+	setup();
+	uint32_t limit = HAL_GetTick() + uint32_t(frames) * 1000;	// Stop if the frames are too rare
+	while (golden.count() < frames && HAL_GetTick() < limit) {
+		loop();
+		sim_advance(1000);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	bool		record		= false;
+	unsigned	steps		= 100;
+	unsigned	seed		= 1;
+	const char	*ref_name	= 0;
+	int opt;
+	while ((opt = getopt(argc, argv, "un:s:r:")) != -1) {
+		switch (opt) {
+			case 'u': record	= true; break;
+			case 'n': steps		= strtoul(optarg, 0, 0); break;
+			case 's': seed		= strtoul(optarg, 0, 0); break;
+			case 'r': ref_name	= optarg; break;
+			default:
+				optind = argc + 1;
+				break;
+		}
+	}
+	if (optind != argc - 1 || steps == 0 || steps * mgr_factor > 0xFFFF) {
+		fprintf(stderr, "Usage: %s [-u] [-n steps] [-s seed] [-r reference] hash_file\n", argv[0]);
+		return 2;
+	}
+
+	const char *hash_name = argv[optind];
+	FILE *gold = fopen(hash_name, record?"w":"r");
+	if (!gold) {
+		perror(hash_name);
+		return 2;
+	}
+	if (record) {
+		fprintf(gold, "# The golden frame hashes, see Host/Src/golden_main.cpp. Record again with 'make golden-update'\n");
+		fprintf(gold, "steps %u seed %u leds %u\n", steps, seed, golden_leds);
+	} else {
+		unsigned leds = 0;
+		int ch;
+		while ((ch = fgetc(gold)) == '#')						// Skip the comment lines
+			while ((ch = fgetc(gold)) != EOF && ch != '\n');
+		ungetc(ch, gold);
+		if (fscanf(gold, " steps %u seed %u leds %u", &steps, &seed, &leds) != 3 || leds != golden_leds
+				|| steps == 0 || steps * mgr_factor > 0xFFFF) {
+			fprintf(stderr, "%s: wrong header\n", hash_name);
+			return 2;
+		}
+	}
+	FILE *ref = 0;
+	if (ref_name) {
+		ref = fopen(ref_name, record?"wb":"rb");
+		if (!ref && record) {
+			perror(ref_name);
+			return 2;
+		}
+	}
+	if (!golden.init(record, steps * mgr_factor, gold, ref)) return 2;
+
+	static const TREE_SPIRAL<golden_leds, 8> tree_spiral;
+	strip.init(golden_leds, &htim2, TIM_CHANNEL_1, &hdma_tim2_ch1, NEO_RGB);
+	tree.init(tree_spiral.map(), golden_leds);
+	sim_setFrameHook(goldenFrame);
+
+	uint16_t cases = 0, failed = 0;
+	for (uint8_t i = 0; i < num_anim; ++i) {
+		animCase(i, seed, steps);
+		failed += !golden.end();
+		++cases;
+	}
+	for (uint8_t i = 0; i < num_clr; ++i) {
+		clearCase(i, seed, steps * 3);							// The clearance runs till it completes
+		failed += !golden.end();
+		++cases;
+	}
+	managerCase(seed, steps * mgr_factor);
+	failed += !golden.end();
+	++cases;
+
+	fclose(gold);
+	if (ref) fclose(ref);
+	if (record)
+		printf("%u cases recorded to %s\n", cases, hash_name);
+	else
+		printf("%u cases, %u differ\n", cases, failed);
+	return failed?1:0;
+}
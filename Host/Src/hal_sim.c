@@ -0,0 +1,173 @@
+#include "hal_sim.h"
+
+#define SIM_BIT_NS			1250							// One PWM period per bit, 800 kHz
+#define SIM_PWM_ONE			37								// The least compare value of one bit: zero is 24 (0.35 uS), one is 49 (0.7 uS)
+#define SIM_FRAME_SIZE		(5000 * 4)						// The longest captured frame, bytes
+#define SIM_TIM_DMA_CC1		1								// The DMA of the capture/compare channel 1 in the timer handle
+
+void DMA1_Channel5_IRQHandler(void);						// The interrupt handler of the timer DMA, see start.cpp
+
+// The peripherals and the handles defined in main.c on the target
+GPIO_TypeDef				sim_gpioa	= { 0xFFFF, 0 };	// The buttons are pulled up
+GPIO_TypeDef				sim_gpiob	= { 0xFFFF, 0 };
+static ADC_TypeDef			adc1;
+static TIM_TypeDef			tim2;
+static DMA_TypeDef			dma1;
+static DMA_Channel_TypeDef	dma1_ch5;
+ADC_HandleTypeDef			hadc1			= { &adc1 };
+DMA_HandleTypeDef			hdma_tim2_ch1	= { &dma1_ch5, HAL_UNLOCKED, HAL_DMA_STATE_READY, 0, 0, 0, 0, 0, 0, &dma1, 16 };
+TIM_HandleTypeDef			htim2			= { &tim2, { 0, &hdma_tim2_ch1 } };
+SPI_HandleTypeDef			hspi1;
+
+static uint64_t			now_ns		= 0;					// The simulated time
+static uint16_t			light		= 0;					// The ADC value
+static SIM_FRAME_HOOK	frame_hook	= 0;
+static uint32_t			frames		= 0;					// The number of the frames transferred
+static volatile uint8_t	running		= 0;					// The timer is started
+static uint8_t			frame[SIM_FRAME_SIZE];				// The frame being captured
+static uint8_t			last[SIM_FRAME_SIZE];				// The last complete frame
+static uint16_t			frame_size	= 0;
+static uint16_t			last_size	= 0;
+static uint8_t			bits		= 0;					// The number of bits in the byte being decoded
+static uint8_t			byte		= 0;
+
+//---------------------------------------------- The simulator interface ------------------------------------------------
+void sim_advance(uint32_t us) {
+	now_ns += (uint64_t)us * 1000;
+}
+
+uint64_t sim_nanos(void) {
+	return now_ns;
+}
+
+void sim_setLight(uint16_t value) {
+	light = value;
+}
+
+void sim_setFrameHook(SIM_FRAME_HOOK hook) {
+	frame_hook = hook;
+}
+
+uint32_t sim_frames(void) {
+	return frames;
+}
+
+const uint8_t* sim_lastFrame(uint16_t *size) {
+	if (size)
+		*size = last_size;
+	return last;
+}
+
+//---------------------------------------------- Timer and DMA ----------------------------------------------------------
+// Decode the PWM compare values transferred to the timer. The zero value is the low line: the reset sequence
+static void decodePWM(const uint8_t *pwm, uint16_t len) {
+	for (uint16_t i = 0; i < len; ++i) {
+		if (pwm[i] == 0)
+			continue;
+		byte = (byte << 1) | (pwm[i] >= SIM_PWM_ONE);
+		if (++bits == 8) {
+			if (frame_size < SIM_FRAME_SIZE)
+				frame[frame_size++] = byte;
+			bits = 0;
+			byte = 0;
+		}
+	}
+	now_ns += (uint64_t)len * SIM_BIT_NS;
+}
+
+// The DMA runs in the circular mode: the half transfer and transfer complete interrupts come in turn until the timer stops
+HAL_StatusTypeDef HAL_TIM_PWM_Start_DMA(TIM_HandleTypeDef *htim, uint32_t Channel, uint32_t *pData, uint16_t Length) {
+	UNUSED(Channel);
+	DMA_HandleTypeDef *hdma	= htim->hdma[SIM_TIM_DMA_CC1];
+	const uint8_t *pwm		= (const uint8_t *)pData;		// The byte-wide transfer to the compare register
+	uint16_t half			= Length >> 1;
+	if (running || !hdma)
+		return HAL_BUSY;
+	hdma->State				= HAL_DMA_STATE_BUSY;
+	hdma->XferCpltCallback	= 0;
+	hdma->Instance->CCR		= DMA_IT_TC | DMA_IT_HT | DMA_IT_TE;
+	frame_size	= 0;
+	bits		= 0;
+	byte		= 0;
+	running		= 1;
+	while (running) {
+		decodePWM(pwm, half);
+		hdma->DmaBaseAddress->ISR |= DMA_FLAG_HT1 << hdma->ChannelIndex;
+		DMA1_Channel5_IRQHandler();
+		decodePWM(pwm + half, half);
+		hdma->DmaBaseAddress->ISR |= DMA_FLAG_TC1 << hdma->ChannelIndex;
+		DMA1_Channel5_IRQHandler();
+	}
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_DMA(TIM_HandleTypeDef *htim, uint32_t Channel) {
+	UNUSED(htim);
+	UNUSED(Channel);
+	if (!running)
+		return HAL_OK;
+	running = 0;
+	for (uint16_t i = 0; i < frame_size; ++i)
+		last[i] = frame[i];
+	last_size = frame_size;
+	++frames;
+	if (frame_hook)
+		frame_hook(last, last_size, HAL_GetTick());
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_RegisterCallback(DMA_HandleTypeDef *hdma, HAL_DMA_CallbackIDTypeDef id, void (*cb)(DMA_HandleTypeDef *hdma)) {
+	switch (id) {
+		case HAL_DMA_XFER_CPLT_CB_ID:		hdma->XferCpltCallback		= cb; break;
+		case HAL_DMA_XFER_HALFCPLT_CB_ID:	hdma->XferHalfCpltCallback	= cb; break;
+		case HAL_DMA_XFER_ERROR_CB_ID:		hdma->XferErrorCallback		= cb; break;
+		case HAL_DMA_XFER_ABORT_CB_ID:		hdma->XferAbortCallback		= cb; break;
+	}
+	return HAL_OK;
+}
+
+//---------------------------------------------- ADC, SPI, GPIO and the system time -------------------------------------
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig) {
+	UNUSED(hadc);
+	UNUSED(sConfig);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef *hadc) {
+	hadc->Instance->DR	= light;
+	hadc->Instance->SR |= ADC_FLAG_EOC;						// The conversion is ready at once
+	return HAL_OK;
+}
+
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef *hadc) {
+	hadc->Instance->SR &= ~ADC_FLAG_EOC;
+	return hadc->Instance->DR;
+}
+
+// The MAX7219 display is not emulated, the transfer takes its time only
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	UNUSED(hspi);
+	UNUSED(pData);
+	UNUSED(Timeout);
+	now_ns += (uint64_t)Size * 8 * 125;						// 8 MHz SPI clock
+	return HAL_OK;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+	return (GPIOx->IDR & GPIO_Pin)?GPIO_PIN_SET:GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+	if (PinState == GPIO_PIN_SET)
+		GPIOx->ODR |= GPIO_Pin;
+	else
+		GPIOx->ODR &= ~GPIO_Pin;
+}
+
+uint32_t HAL_GetTick(void) {
+	return now_ns / 1000000;
+}
+
+void HAL_Delay(uint32_t Delay) {
+	now_ns += (uint64_t)Delay * 1000000;
+}
@@ -0,0 +1,119 @@
+/*
+ * The host simulator: runs setup() and loop() of the project headless with the emulated peripherals.
+ * Usage: sim [-t ms] [-s light] [-l us] [-o file] [-m file]
+ *	-t	the simulated time to run, milliseconds (10 minutes by default)
+ *	-s	the ambient light value read by setup(), it seeds the random generator
+ *	-l	the simulated duration of one loop() call, microseconds (1000 by default)
+ *	-o	dump the frames to the file. Every frame is the record: the tick (uint32_t), the number of bytes (uint16_t),
+ *		both little-endian, and the LED bytes in the output order
+ *	-m	the measured LED coordinates of the tree instead of the spiral, the file has the TREE_MAP_FILE format (see start.cpp):
+ *		the { height, angle, radius }, entries, one per LED from the beginning of the strip
+ */
+
+#include "hal_sim.h"
+#include "start.h"
+#include "tree3d.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+static FILE	*dump = 0;
+
+static void dumpFrame(const uint8_t *bytes, uint16_t size, uint32_t tick) {
+	uint8_t head[6] = {
+		uint8_t(tick), uint8_t(tick >> 8), uint8_t(tick >> 16), uint8_t(tick >> 24), uint8_t(size), uint8_t(size >> 8)
+	};
+	fwrite(head, 1, sizeof(head), dump);
+	fwrite(bytes, 1, size, dump);
+}
+
+// Read the { h, a, r } entries of the file, return the number of LEDs read or 0 on the error
+static uint16_t loadTreeMap(const char *name, LED_POS **map) {
+	FILE *f = fopen(name, "r");
+	if (!f) {
+		perror(name);
+		return 0;
+	}
+	uint16_t size = 0, allocated = 0;
+	LED_POS	*pos  = 0;
+	int		 ch;
+	while ((ch = fgetc(f)) != EOF) {
+		if (ch != '{') continue;
+		int h, a, r;
+		if (fscanf(f, " %i , %i , %i }", &h, &a, &r) != 3 || h < 0 || h > 255 || a < 0 || a > 255 || r < 0 || r > 255) {
+			fprintf(stderr, "%s: the entry %u is not { height, angle, radius } of 0...255\n", name, size + 1);
+			size = 0;
+			break;
+		}
+		if (size >= allocated) {
+			allocated = allocated?allocated * 2:256;
+			pos = (LED_POS *)realloc(pos, allocated * sizeof(LED_POS));
+		}
+		pos[size++] = { uint8_t(h), uint8_t(a), uint8_t(r) };
+	}
+	fclose(f);
+	if (!size) {
+		free(pos);
+		pos = 0;
+	}
+	*map = pos;
+	return size;
+}
+
+static double wallSeconds(void) {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t duration	= 600000;
+	uint32_t loop_us	= 1000;
+	uint16_t light		= 0;
+	LED_POS	*tree_map	= 0;
+	uint16_t tree_size	= 0;
+	int opt;
+	while ((opt = getopt(argc, argv, "t:s:l:o:m:")) != -1) {
+		switch (opt) {
+			case 't': duration	= strtoul(optarg, 0, 0); break;
+			case 's': light		= strtoul(optarg, 0, 0); break;
+			case 'l': loop_us	= strtoul(optarg, 0, 0); break;
+			case 'o':
+				dump = fopen(optarg, "wb");
+				if (!dump) {
+					perror(optarg);
+					return 1;
+				}
+				sim_setFrameHook(dumpFrame);
+				break;
+			case 'm':
+				tree_size = loadTreeMap(optarg, &tree_map);
+				if (!tree_size) return 1;
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-t ms] [-s light] [-l us] [-o file] [-m file]\n", argv[0]);
+				return 2;
+		}
+	}
+
+	sim_setLight(light);
+	double start = wallSeconds();
+	setup();
+	if (tree_map)
+		tree.init(tree_map, tree_size);								// The measured coordinates replace the compiled ones
+	while (HAL_GetTick() < duration) {
+		loop();
+		sim_advance(loop_us);
+	}
+	double wall = wallSeconds() - start;
+	if (dump)
+		fclose(dump);
+	free(tree_map);
+
+	uint16_t size;
+	sim_lastFrame(&size);
+	printf("%u frames of %u bytes in %u ms simulated, %.2f s wall, %.0fx real time\n",
+			sim_frames(), size, HAL_GetTick(), wall, (wall > 0)?HAL_GetTick() / (wall * 1000):0);
+	return 0;
+}
@@ -2,8 +2,14 @@
 #define __ANIMATION_H
 #include "main.h"
 #include "clrutils.h"
+#include "particles.h"
+#include "fire.h"
+#include "palette.h"
+#include "noise.h"
+#include "blur.h"
 
 const uint8_t		min_time     = 30;							// Minimal sequence show time (seconds)
+const uint8_t		max_catch_up = 4;							// Maximum number of the delayed steps made at once
 
 //---------------------------------------------- Base animation class with useful functions -------------------------------
 class animation {
@@ -12,12 +18,28 @@ class animation {
     	virtual		~animation(void)							{ }
     	virtual		void init(void) = 0;
     	virtual		void show(void) = 0;
+    	virtual		bool advance(uint32_t ms, uint16_t period);
+    	void		resetTime(void)								{ time_set = false; }
     	void		getLimits(uint8_t& mi_p, uint8_t& ma_p)		{ mi_p = min_p; ma_p = max_p; }
+    	void		setPalette(const PALETTE* p)				{ pal = (p && p->isLoaded())?p:0; }
     	uint8_t		min_p;										// The minimum period in tenth of second to show the stage
     	uint8_t		max_p;										// The maximum period in tenth of second to show the stage
     	uint8_t		show_time;									// The minimum time to show whole the sequence in 10-seconds intervals
     	bool		do_clear;									// Whether the strip have to be cleaned for the next loop
     	bool		complete;									// Whether the animation can be changed to the next one
+    	bool		spatial;									// Whether the animation draws by the LED position, so it needs the whole strip
+	protected:
+    	uint32_t	timeDelta(uint32_t ms);
+    	uint32_t	timeSteps(uint32_t ms, uint16_t period);
+    	COLOR		wheel(uint8_t w)							{ return pal?pal->colorFromPalette(w):strip.wheel(w); }
+    	const COLOR* wheelTable(void)							{ return pal?pal->table():wheelLUT().table(); }	// The wheel() colors for the indexed mode
+    	const PALETTE* pal		= 0;							// The palette instead of the color wheel, if not null
+	private:
+    	void		startTime(uint32_t ms);
+    	uint32_t	next_step	= 0;							// The time of the next fixed step, ms
+    	uint32_t	last_ms		= 0;							// The time of the previous timeDelta() call, ms
+    	uint16_t	step_rem	= 0;							// The remainder of the timeSteps() division
+    	bool		time_set	= false;						// Whether the animation time has been started after init()
 };
 
 // --------------------------------------------- Fill the dots one after the other with a color ---------------------------
@@ -64,7 +86,9 @@ class colorWave: public animation, public CRAWL, public BRGTN {
     	virtual void	init(void);
     	virtual void	show(void);
   	  private:
+    	bool			startIndexed(void);
     	uint8_t			index;
+    	uint16_t		steps		= 0;						// The number of crawl steps after the strip lit up
     	bool			rdy;
 };
 
@@ -72,10 +96,13 @@ class colorWave: public animation, public CRAWL, public BRGTN {
 class rainbow: public animation, public BRGTN {
 	public:
     	rainbow(void)											{ index = 0; rdy = false; }
-    	virtual void 	init(void)								{ index = 0; rdy = false; }
+    	virtual void 	init(void)								{ index = 0; phase = 0; rdy = false; }
     	virtual void 	show(void);
+    	virtual bool	advance(uint32_t ms, uint16_t period);
 	private:
+    	void			draw(void);
     	uint8_t			index;
+    	uint16_t		phase		= 0;						// The color wheel index in 1/256 units
     	bool			rdy;
 };
 
@@ -83,10 +110,13 @@ class rainbow: public animation, public BRGTN {
 class rainCycle: public animation, public BRGTN {
 	public:
     	rainCycle(void)											{ index = 0; rdy = false; }
-    	virtual void	init(void)								{ index = 0; rdy = false; }
+    	virtual void	init(void)								{ index = 0; phase = 0; rdy = false; }
     	virtual void	show(void);
+    	virtual bool	advance(uint32_t ms, uint16_t period);
 	private:
+    	void			draw(void);
     	uint8_t			index;
+    	uint16_t		phase		= 0;						// The color wheel index in 1/256 units
     	bool 			rdy;
 };
 
@@ -102,25 +132,29 @@ class rainFull: public animation, public BRGTN {
 };
 
 //---------------------------------------------- Light up with the Random color than fade out -----------------------------
-class lightUp : public animation, public BRGTN {
+class lightUp : public animation {
 	public:
     	lightUp()												{ min_p = 6; max_p = 24; show_time = 12; sp = inc = 0; }
-    	virtual void	init(void)								{ sp = 1; inc = sp; newColor(); }
+    	virtual void	init(void)								{ sp = 1; inc = sp; val = 0; newColor(); }
     	virtual void	show(void);
 	private:
     	void			newColor(void);
     	uint8_t			sp;
     	int8_t			inc;
+    	uint8_t			hue			= 0;						// The hue of the first pixel
+    	int16_t			hue_step	= 0;						// The hue change per pixel in 1/256 units
+    	uint8_t			sat			= 255;
+    	uint8_t			val			= 0;						// The current brightness of the strip
 };
 
 //---------------------------------------------- aRandom sparcs ------------------------------------------------------------
 class sparks : public animation, public BRGTN {
 	public:
     	sparks()												{ min_p = 2; max_p = 6; show_time = 12; }
-    	virtual void	init(void)								{ for (uint8_t i = 0; i < 8; ++i) pos[i] = 0; }
+    	virtual void	init(void);
     	virtual void	show(void);
 	private:
-    	uint16_t		pos[8];
+    	PARTICLES		pt;										// The lit sparks, the age is the time since the spark flashed
 };
 
 //---------------------------------------------- aRandom sparks fade out ---------------------------------------------------
@@ -219,16 +253,14 @@ class collideOne : public animation {
 };
 
 //---------------------------------------------- Neo fire animation by Robert Ulbricht ----------------------------------
-class neoFire : public animation, public BLEND {
+class neoFire : public animation {
 	public:
-    	neoFire()												{ min_p = 1; max_p = 5; color = 0; pause = 0; }
+    	neoFire()												{ min_p = 1; max_p = 5; }
     	virtual void	init(void);
     	virtual void	show(void);
 	private:
-    	COLOR			color;
-    	int8_t			pause;
-    	const 	COLOR	c1 = 80;
-    	const 	COLOR	c2 = 25;
+    	FIRE			fire;
+    	uint8_t			rotate		= 0;						// Rotate the color components of the fire: 0 - red fire
 };
 
 //---------------------------------------------- Even and odd position leds are moving towards each other ---------------
@@ -352,36 +384,33 @@ class singleWave : public animation, public BRGTN {
 //---------------------------------------------- Several worms are moving Randomly ---------------------------------------
 class worms : public animation, public BRGTN, public TWOCLR {
 	public:
-    	worms()													{ min_p = 10; max_p = 20; show_time = 9; active = 0; }
+    	worms()													{ min_p = 10; max_p = 20; show_time = 9; }
     	virtual void	init(void);
     	virtual void	show(void);
 	private:
     	void			add(void);
-    	void			die(uint8_t index);
-    	struct worm {
-    		COLOR		color;
-    		int16_t		pos;
-    		bool		fwd;
-    	};
-    	struct			worm w[5];
-    	uint8_t			active;
+    	PARTICLES		pt;										// The worms, the velocity is the direction: 1 or -1
 };
 
 //---------------------------------------------- Show interferention from many sources ----------------------------------
-class interfer : public animation, public TWOCLR {
-  #define num_inter 3
+class interfer : public animation {
+  #define num_inter 32
 	public:
-    	interfer()												{ min_p = 6; max_p = 10; show_time = 6; tm = active = 0; }
+    	interfer()												{ min_p = 6; max_p = 10; show_time = 6; tm = active = limit = 0; }
     	virtual void	init(void);
     	virtual void	show(void);
-	private:
+	protected:
     	void			add(void);
-    	uint32_t		clr(int p, uint8_t source);
     	int16_t			tm;										// Time the animation starts (in cycles)
     	int16_t			pos[num_inter];							// The position of the source
     	int16_t			start[num_inter];						// Time when the source activated
     	uint8_t			w[num_inter];							// Wheel Color index of the source
     	uint8_t			active;									// The number of active sources
+    	uint8_t			limit;									// The maximum number of sources on the strip
+    	// The source data of the current frame
+    	COLOR			color[num_inter];						// The color of the source
+    	int16_t			first[num_inter], last[num_inter];		// The pixels reached by the wave
+    	uint8_t			phase[num_inter];						// The wave phase at the current pixel (modulo 64)
 };
 
 //------------------------------------------- Random  colors toward each other ------------------------------------------
@@ -422,17 +451,12 @@ class lghtHouse : public animation, public BRGTN {
 //---------------------------------------------- Random dropped color dot fading out from epicenter ----------------------
 class rndDrops : public animation, public BRGTN, public TWOCLR {
 	public:
-    	rndDrops()												{ min_p = 2; max_p = 7; show_time = 9; num = 0; }
-    	virtual void 	init(void)								{ num = 0; add(); }
+    	rndDrops()												{ min_p = 2; max_p = 7; show_time = 9; }
+    	virtual void 	init(void);
     	virtual void 	show(void);
 	private:
     	void 			add(void);
-    	struct drop {
-    		int16_t		pos;
-    		int8_t		tm;
-    	};
-    	struct			drop dr[16];
-    	int8_t			num;
+    	PARTICLES		pt;										// The drops, the age is the wave radius
 };
 
 // --------------------------------------------- Solitons are creaping up or down -----------------------------------------
@@ -490,15 +514,18 @@ class symmRun: public animation, public BRGTN {
 };
 
 // --------------------------------------------- Defined Meteors falling down fast ----------------------------------------
-class metSingle: public animation {
+class metSingle: public animation, public SUBPIXEL {
 	public:
-		metSingle(void)											{ min_p = 1; max_p = 3; show_time = 3; }
+		metSingle(bool sub_pixel = false)						{ min_p = 1; max_p = 3; show_time = 3; smooth = sub_pixel; }
 		virtual void	init(void);
 		virtual void	show(void);
 	private:
+		void			showSmooth(void);
 		uint8_t			head	= 0;
-		const COLOR		clr[8] 	= { 0xffb844, 0xfcff96, 0xfdffce, 0xffffff, 0xffb540, 0xfe9e4a, 0xe65634, 0x91182b };
-		const uint8_t	clr_size = 8;
+		uint32_t		head_fp	= 0;							// The head position in 1/256 pixel, sub-pixel mode
+		bool			smooth	= false;						// Whether the meteor moves by half of the pixel
+		static const uint8_t clr_size = 8;
+		COLOR			clr[clr_size];							// The meteor colors from the head to the tail
 };
 
 // --------------------------------------------- Classical multicolor strip simulation ------------------------------------
@@ -531,17 +558,21 @@ class sideFill: public animation, public BRGTN {
 };
 
 // --------------------------------------------- Browian Motion with the tail --------------------------------------------
-class browMotion: public animation, public BRGTN {
+class browMotion: public animation, public BRGTN, public SUBPIXEL {
 	public:
-		browMotion(void)										{ min_p = 3; max_p = 8; show_time = 4; }
+		browMotion(bool sub_pixel = false)						{ min_p = 3; max_p = 8; show_time = 4; smooth = sub_pixel; }
 		virtual void	init(void);
 		virtual void	show(void);
 	private:
 		void			newDestination(uint16_t num_pixels);
+		void			moveSmooth(COLOR c, uint8_t bell, uint16_t num_pixels);
 		uint8_t			w			= 0;						// color wheel index
 		int8_t			speed		= 0;						// distance of one move
 		uint16_t		pos			= 0;						// current position
 		uint16_t		destination	= 0;						// next destination index (0 - num_pixel)
+		uint16_t		start		= 0;						// the position where the move to destination started
+		uint32_t		pos_fp		= 0;						// current position in 1/256 pixel, sub-pixel mode
+		bool			smooth		= false;					// Whether the dot moves by the fraction of the pixel
 };
 
 // --------------------------------------------- Rain drops running down -------------------------------------------------
@@ -551,14 +582,8 @@ class rainDrops: public animation, public BRGTN {
 		virtual void	init(void);
 		virtual void	show(void);
 	private:
-    	struct r_drop {
-    		uint16_t	head;									// Position of the drop
-    		COLOR		c;										// color of the drop
-    		uint8_t		speed;									// Speed: the number of pixel crossed by one move
-    	}				drop[10];
     	void			newDrop(void);
-    	const uint8_t	max_drops	= 10;
-    	uint8_t			active_drops = 0;
+    	PARTICLES		pt;										// The drops, the velocity is the number of pixel crossed by one move
 };
 
 // --------------------------------------------- Ripe fruits booms and run two pieces ------------------------------------
@@ -568,14 +593,8 @@ class ripeFruit: public animation, public BRGTN {
 		virtual void	init(void);
 		virtual void	show(void);
 	private:
-    	struct r_fruit {
-    		uint16_t	part[2];								// Position of the half of the fruit
-    		COLOR		c;										// color of the fruit
-    		uint8_t		speed;									// Speed: the number of pixel crossed by one move
-    	}				fruit[10];;
     	void			newFruit(void);
-    	const uint8_t	max_fruits	= 10;
-    	uint8_t			active_fruits = 0;
+    	PARTICLES		pt;										// The fruits, the position and aux are the halves of the fruit
 };
 
 // --------------------------------------------- The single color that changes the brightness as a sine ------------------
@@ -584,10 +603,15 @@ class brightWave: public animation, public WAVE {
 		brightWave(void)										{ min_p = 6; max_p = 16; show_time = 4; }
 		virtual void	init(void);
 		virtual void	show(void);
+		virtual bool	advance(uint32_t ms, uint16_t period);
 	private:
-		uint8_t			w	= 0;								// The color wheel index
-		uint8_t			t	= 0;
-		bool			fwd	= false;
+		void			draw(void);
+		void			move(uint32_t steps);
+		uint8_t			w			= 0;						// The color wheel index
+		uint32_t		t			= 0;						// The wave phase of the first pixel in 1/256 units
+		uint16_t		wave_step	= 0;						// The phase increment between two neighbor pixels
+		uint16_t		step_part	= 0;						// The part of the step made, 1/256 units
+		bool			fwd			= false;
 };
 
 // --------------------------------------------- Color pixels walking up and down with sine brightness -------------------
@@ -597,27 +621,56 @@ class brColCreep: public animation, public WAVE, public CRAWL {
 		virtual void	init(void);
 		virtual void	show(void);
 	private:
-		uint8_t			w	= 0;								// The color wheel index
-		uint8_t			t	= 0;
+		uint8_t			w			= 0;						// The color wheel index
+		uint16_t		t			= 0;						// The wave phase of the new pixel
+		uint16_t		wave_step	= 0;						// The phase increment of one step
 };
 
 // --------------------------------------------- Color drops increasing brightness and then generates the fading wave ----
-class dropFade: public animation, public BRGTN {
+class dropFade: public animation, public BRGTN, public BLUR {
 	public:
 		dropFade(void)											{ min_p = 6; max_p = 16; show_time = 6; }
 		virtual void	init(void);
 		virtual void	show(void);
 	private:
 		void			newDrop(void);
-		bool			isActiveDrop(uint16_t pos);
-		struct	c_drop {
-			uint16_t	pos;									// Rising pixel position
-			uint8_t		w;										// The wheel index of the pixel color
-			bool		remove;									// The pixel should be deleted
-		}				drop[15];
-
-		uint8_t			active_drops	= 0;					// The number of the active drops
-		const uint8_t	max_drops		= 15;
+		PARTICLES		pt;										// The rising drops, aux is the wheel index, color is the drop color
+};
+
+// --------------------------------------------- The lava lamp: slow blobs of the noise colored by the palette -----------
+class lavaLamp: public animation {
+	public:
+		lavaLamp(void)											{ min_p = 2; max_p = 5; show_time = 6; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		uint16_t		t			= 0;						// The noise time coordinate
+		uint8_t			scale		= 0;						// The noise coordinate increment per pixel
+		uint8_t			speed		= 0;						// The noise time increment per step
+};
+
+// --------------------------------------------- The aurora: green to violet curtains waving slowly ----------------------
+class aurora: public animation {
+	public:
+		aurora(void)											{ min_p = 2; max_p = 5; show_time = 6; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		uint16_t		t			= 0;						// The noise time coordinate
+		uint8_t			scale		= 0;						// The noise coordinate increment per pixel
+		uint8_t			speed		= 0;						// The noise time increment per step
+};
+
+// --------------------------------------------- The candles: each pixel is a flickering flame ---------------------------
+class candles: public animation {
+	public:
+		candles(void)											{ min_p = 2; max_p = 4; show_time = 4; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		uint16_t		t			= 0;						// The noise time coordinate
+		uint8_t			hue			= 0;						// The flame hue: from red to yellow
+		uint8_t			speed		= 0;						// The noise time increment per step
 };
 
 #endif
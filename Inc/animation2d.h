@@ -0,0 +1,65 @@
+#ifndef __ANIMATION2D_H
+#define __ANIMATION2D_H
+#include "animation.h"
+#include "matrix.h"
+
+/*
+ * The animations for the 2D LED panel. They draw through the global matrix (see matrix.h),
+ * which should be initialized before the animation starts. The matrix covers the whole strip,
+ * so the animations are spatial and the manager never runs them in a zone.
+ */
+
+// --------------------------------------------- Rain drops falling down the panel columns --------------------------------
+class mxRainDrops: public animation, public BRGTN {
+	public:
+		mxRainDrops(void)										{ min_p = 6; max_p = 16; show_time = 4; spatial = true; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		struct r_drop {
+			uint8_t		x;										// The column of the drop
+			int16_t		y;										// The row of the drop head
+			COLOR		c;										// color of the drop
+			uint8_t		speed;									// Speed: the number of pixel crossed by one move
+		}				drop[16];
+		void			newDrop(void);
+		const uint8_t	max_drops	= 16;
+		uint8_t			active_drops = 0;
+};
+
+// --------------------------------------------- The rainbow running along the panel diagonal ----------------------------
+class mxRainbow: public animation, public BRGTN {
+	public:
+		mxRainbow(void)											{ min_p = 2; max_p = 6; show_time = 4; spatial = true; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		uint8_t			index		= 0;						// The color wheel index of the top left corner
+		uint8_t			dx			= 0;						// The color wheel increment of the next column
+		uint8_t			dy			= 0;						// The color wheel increment of the next row
+};
+
+// --------------------------------------------- The line bouncing from the panel borders leaving the fading trace --------
+class mxLines: public animation, public BRGTN {
+	public:
+		mxLines(void)											{ min_p = 4; max_p = 10; show_time = 4; spatial = true; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		void			move(int16_t& p, int8_t& v, uint8_t size);
+		int16_t			x[2]		= { 0 };					// The line end points
+		int16_t			y[2]		= { 0 };
+		int8_t			vx[2]		= { 0 };					// The end point velocity
+		int8_t			vy[2]		= { 0 };
+		uint8_t			w			= 0;						// The color wheel index
+};
+
+// --------------------------------------------- Color boxes appearing at random places and fading out -------------------
+class mxBoxes: public animation, public BRGTN {
+	public:
+		mxBoxes(void)											{ min_p = 6; max_p = 16; show_time = 4; spatial = true; }
+		virtual void	init(void);
+		virtual void	show(void);
+};
+
+#endif
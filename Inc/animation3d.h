@@ -0,0 +1,63 @@
+#ifndef __ANIMATION3D_H
+#define __ANIMATION3D_H
+#include "animation.h"
+#include "tree3d.h"
+
+/*
+ * The spatial animations of the tree installation. They use the LED coordinates of the global tree (see tree3d.h)
+ * and the physical LED numbers, so the manager never runs them in a zone.
+ */
+
+// --------------------------------------------- The horizontal plane moving up and down the tree ------------------------
+class treeSweep: public animation {
+	public:
+		treeSweep(void)											{ min_p = 2; max_p = 6; show_time = 4; spatial = true; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		uint8_t			level		= 0;						// The height of the plane
+		int8_t			speed		= 0;						// The plane move per step
+		uint8_t			width		= 0;						// The plane thickness
+		uint8_t			w			= 0;						// The color wheel index
+};
+
+// --------------------------------------------- Two light beams rotating around the trunk -------------------------------
+class treeBeam: public animation {
+	public:
+		treeBeam(void)											{ min_p = 2; max_p = 6; show_time = 4; spatial = true; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		uint8_t			direction	= 0;						// The angle of the first beam
+		int8_t			speed		= 0;						// The rotation angle per step
+		uint8_t			width		= 0;						// The beam angular width
+		uint8_t			w			= 0;						// The color wheel index of the first beam
+};
+
+// --------------------------------------------- The spheres growing from the random points inside the tree --------------
+class treePulse: public animation, public BRGTN {
+	public:
+		treePulse(void)											{ min_p = 2; max_p = 6; show_time = 4; spatial = true; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		void			newPulse(void);
+		int8_t			cx			= 0;						// The center of the sphere
+		int8_t			cy			= 0;
+		uint8_t			ch			= 0;
+		uint16_t		radius		= 0;
+		COLOR			c			= 0;						// The sphere color
+};
+
+// --------------------------------------------- The flames rise from the bottom of the tree around the trunk -----------
+class treeFire: public animation {
+	public:
+		treeFire(void)											{ min_p = 2; max_p = 5; show_time = 4; spatial = true; }
+		virtual void	init(void);
+		virtual void	show(void);
+	private:
+		FIRE			fire;									// Every flame is an angular sector of the tree
+		const uint8_t	levels		= 32;						// The number of the heat cells from the bottom to the top
+};
+
+#endif
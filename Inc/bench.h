@@ -0,0 +1,39 @@
+#ifndef __BENCH_H
+#define __BENCH_H
+#include "animation.h"
+
+/*
+ * The performance benchmark of the animations and the drawing primitives on the current strip.
+ * Every animation makes 'frames' steps, one advance() call per the shortest step period (min_p), each step is timed.
+ * The animation is initialized again when it asks for clearing, this time is not counted.
+ * The report is the CSV line per animation and strip length: the render time statistics in microseconds
+ * and the number of pixel reads and writes per step (zero if the driver is built without WS2811B_STATS).
+ * The animation is named by its index in the list.
+ * The platform functions: the cycle counter and the line output. On the target the DWT cycle counter
+ * and the SWO (ITM stimulus port 0) are used, the host build provides its own implementation.
+ * To run the benchmark on the target, define BENCHMARK and WS2811B_STATS in the project symbols (see start.cpp)
+ * and read the SWO output at the core clock / SWO prescaler.
+ */
+
+void		benchClockStart(void);
+uint32_t	benchCycles(void);
+uint32_t	benchCyclesPerUs(void);
+void		benchPrint(const char *line);
+
+class BENCH {
+	public:
+		BENCH(void)													{ }
+		bool		init(uint16_t frames);
+		void		header(void);
+		void		animations(animation* a[], uint8_t num);
+		void		kernels(void);
+	private:
+		template <typename PREPARE, typename RUN> void kernel(const char *name, PREPARE prep, RUN run);
+		void		report(const char *name, uint32_t period_us);
+		uint32_t*	samples		= 0;								// The step times, cycles
+		uint16_t	frames		= 0;								// The number of steps to measure
+		uint32_t	reads		= 0;								// The pixel reads of all the steps
+		uint32_t	writes		= 0;								// The LED writes of all the steps
+};
+
+#endif
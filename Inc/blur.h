@@ -0,0 +1,27 @@
+#ifndef __BLUR_H
+#define __BLUR_H
+#include "clrutils.h"
+
+/*
+ * The whole-strip one-dimensional blur of the canvas in the current view range.
+ * box() replaces every pixel with the average of 2*radius+1 neighbors. The window sum is kept in two 32-bit words,
+ * two color components per word, and is updated by one pixel added and one pixel removed, so the cost does not
+ * depend on the radius. The average is the multiplication by the reciprocal of the window width, no division.
+ * The blur is made in place, the original colors of the last radius+1 pixels are kept in the small ring buffer
+ * on the stack. The pixels outside of the range are assumed to be the same as the edge pixels.
+ * gauss() is three box passes, close to the gaussian curve. glow() adds the blurred picture to the original one.
+ * blur1d() spreads the amount/2 of every pixel to its two neighbors in one pass, like the FastLED blur1d().
+ * The indexed strip is not blurred: the neighbor indexes can not be averaged.
+ */
+
+class BLUR {
+	public:
+		BLUR()														{ }
+		void		box(uint8_t radius);
+		void		gauss(uint8_t radius);
+		void		glow(uint8_t radius, uint8_t gain);
+		void		blur1d(uint8_t amount);
+		static const uint8_t max_radius = 16;
+};
+
+#endif
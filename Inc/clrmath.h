@@ -0,0 +1,136 @@
+#ifndef __CLRMATH_H
+#define __CLRMATH_H
+#include "ws2811b.h"
+
+/*
+ * Packed color arithmetic.
+ * Every function processes all four 8-bit components of the COLOR (W-R-G-B) at once inside 32-bit register,
+ * so no unpacking of the color into the components is required.
+ * The component does not affect its neighbors: the carry or borrow never crosses the byte boundary.
+ * If the core supports DSP extension (Cortex-M4, M7), the saturating addition and subtraction use UQADD8 and UQSUB8
+ * instructions. The Cortex-M3 has no such instructions, the SWAR (SIMD within a register) code is used instead.
+ */
+
+#define CLR_LOW7	0x7F7F7F7F									// Low 7 bits of each component
+#define CLR_HIGH	0x80808080									// Most significant bit of each component
+
+// Expand the most significant bit of each component to whole component: 0x80 -> 0xFF
+static inline COLOR clrMask(COLOR high_bits) {
+	return (high_bits >> 7) * 0xFF;
+}
+
+// Add the components modulo 256 (the overflow is lost)
+static inline COLOR clrAddWrap(COLOR a, COLOR b) {
+	return ((a & CLR_LOW7) + (b & CLR_LOW7)) ^ ((a ^ b) & CLR_HIGH);
+}
+
+// Add the components, limit the result by 255
+static inline COLOR clrAdd(COLOR a, COLOR b) {
+#if defined(__ARM_FEATURE_SIMD32)
+	COLOR r;
+	__asm__ ("uqadd8 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+	return r;
+#else
+	COLOR s		= (a & CLR_LOW7) + (b & CLR_LOW7);				// The carry of low 7 bits goes to the most significant bit
+	COLOR carry	= ((a & b) | ((a ^ b) & s)) & CLR_HIGH;			// The carry out of each component
+	s ^= (a ^ b) & CLR_HIGH;
+	return s | clrMask(carry);
+#endif
+}
+
+// The mask of the components where a < b (0xFF in such component)
+static inline COLOR clrLess(COLOR a, COLOR b) {
+	COLOR d = (a | CLR_HIGH) - (b & CLR_LOW7);					// Most significant bit is cleared when the borrow happens
+	return clrMask(((~a & b) | (~(a ^ b) & ~d)) & CLR_HIGH);
+}
+
+// Subtract the components, limit the result by 0
+static inline COLOR clrSub(COLOR a, COLOR b) {
+#if defined(__ARM_FEATURE_SIMD32)
+	COLOR r;
+	__asm__ ("uqsub8 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+	return r;
+#else
+	COLOR d 	 = (a | CLR_HIGH) - (b & CLR_LOW7);
+	COLOR borrow = ((~a & b) | (~(a ^ b) & ~d)) & CLR_HIGH;		// The borrow out of each component
+	d ^= (a ^ ~b) & CLR_HIGH;
+	return d & ~clrMask(borrow);
+#endif
+}
+
+// The mask of the equal components (0xFF in such component)
+static inline COLOR clrEqual(COLOR a, COLOR b) {
+	COLOR x = a ^ b;
+	x |= ((x & CLR_LOW7) + CLR_LOW7);							// Most significant bit is set in not zero component
+	return clrMask(~x & CLR_HIGH);
+}
+
+static inline COLOR clrMin(COLOR a, COLOR b) {
+	COLOR m = clrLess(a, b);
+	return (a & m) | (b & ~m);
+}
+
+static inline COLOR clrMax(COLOR a, COLOR b) {
+	COLOR m = clrLess(a, b);
+	return (b & m) | (a & ~m);
+}
+
+// Scale the components: c * factor / 256, factor is 0...256
+static inline COLOR clrScale(COLOR c, uint16_t factor) {
+	COLOR rb = ((c & 0x00FF00FF) * factor) >> 8;				// Two components in 16-bit lanes, 255*256 fits the lane
+	COLOR wg = ((c >> 8) & 0x00FF00FF) * factor;
+	return (rb & 0x00FF00FF) | (wg & 0xFF00FF00);
+}
+
+// Linear interpolation between two colors: a + (b - a) * frac / 256, frac is 0...256
+static inline COLOR clrLerp(COLOR a, COLOR b, uint16_t frac) {
+	uint16_t ia	= 256 - frac;
+	COLOR rb	= ((a & 0x00FF00FF) * ia + (b & 0x00FF00FF) * frac) >> 8;
+	COLOR wg	= ((a >> 8) & 0x00FF00FF) * ia + ((b >> 8) & 0x00FF00FF) * frac;
+	return (rb & 0x00FF00FF) | (wg & 0xFF00FF00);
+}
+
+/*
+ * Multiply two pairs of components: a * (b + 1) / 256, the components are in the bits 0...7 and 24...31.
+ * One 32x32->64 multiplication for both pairs: the cross products fall into the bits 24...40,
+ * so they never reach the product of the high components (bits 48...63)
+ */
+static inline COLOR clrMul2(COLOR a, COLOR b) {
+	uint64_t p = uint64_t(a) * b + a + (uint64_t(a) << 24);		// a * (b + 1) in both lanes
+	return COLOR((p >> 8) & 0xFF) | (COLOR(p >> 56) << 16);
+}
+
+// Multiply the components: a * b / 255 (b = 255 keeps a unchanged), two components per multiplication
+static inline COLOR clrMul(COLOR a, COLOR b) {
+	COLOR rb = clrMul2((a & 0xFF) | ((a & 0x00FF0000) << 8), (b & 0xFF) | ((b & 0x00FF0000) << 8));
+	COLOR wg = clrMul2(((a >> 8) & 0xFF) | (a & 0xFF000000), ((b >> 8) & 0xFF) | (b & 0xFF000000));
+	return rb | (wg << 8);
+}
+
+/*
+ * The scale8 family: the fixed point scaling by the fraction of 255. The scale value 255 means 1.0, 0 means 0.0
+ * scale8(i, scale)        = floor(i * (scale + 1) / 256); scale8(i, 255) == i, scale8(i, 0) == 0
+ * scale8_video(i, scale)  = floor(i * scale / 256) + 1 if both i and scale are not zero, otherwise 0.
+ *                           The not zero value never becomes zero, the dim pixel is not switched off
+ * nscale8(c, scale)       = scale8() applied to each component of the color
+ * nscale8_video(c, scale) = scale8_video() applied to each component of the color
+ * No division is used, the scaling is a multiplication and a shift
+ */
+static inline uint8_t scale8(uint8_t i, uint8_t scale) {
+	return (uint16_t(i) * (uint16_t(scale) + 1)) >> 8;
+}
+
+static inline uint8_t scale8_video(uint8_t i, uint8_t scale) {
+	return ((uint16_t(i) * scale) >> 8) + ((i && scale)?1:0);
+}
+
+static inline COLOR nscale8(COLOR c, uint8_t scale) {
+	return clrScale(c, uint16_t(scale) + 1);
+}
+
+static inline COLOR nscale8_video(COLOR c, uint8_t scale) {
+	if (scale == 0) return 0;
+	return clrScale(c, scale) + (~clrEqual(c, 0) & 0x01010101);	// The scaled component is less than 255, no overflow
+}
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef __CLRUTILS_H
 #define __CLRUTILS_H
 #include "tools.h"
+#include "sine.h"
+#include "clrmath.h"
 #include "ws2811b_cpp.h"
 
 extern NEOPIXEL		strip;
@@ -24,7 +26,7 @@ class BRGTN {
     	bool		change(uint16_t index, int8_t val);
     	bool		changeAll(int8_t val);
 	protected:
-    	uint8_t		color[3];
+    	COLOR		color		= 0;							// The preset color to be reached by the increment
 };
 
 //---------------------------------------------- Blend manipulations ------------------------------------------------------
@@ -36,6 +38,21 @@ class BLEND {
     	void		blendPixel(uint16_t p, uint8_t deviation = 20);
 };
 
+//---------------------------------------------- Sub-pixel rendering -----------------------------------------------------
+/*
+ * The position and the length are fixed point numbers in 1/256 of pixel (Q8.8, the integer part can exceed 255).
+ * The color intensity is split between the pixels covered by the shape in proportion to the coverage
+ * and added to the pixel colors with saturation, so the object moves smoothly by the fraction of the pixel.
+ */
+class SUBPIXEL {
+	public:
+		SUBPIXEL()													{ }
+		void		dot(uint32_t pos, COLOR c);
+		void		segment(uint32_t pos, uint32_t len, COLOR c);
+	private:
+		void		addPixel(uint16_t n, COLOR c, uint16_t cover);
+};
+
 //---------------------------------------------- Color superposition class ------------------------------------------------
 class TWOCLR {
 	public:
@@ -47,10 +64,10 @@ class TWOCLR {
 class WAVE {
 	public:
     	WAVE()														{ }
-    	uint8_t	amplitude(uint8_t n);								// sin(PI*n/32) * 127 + 127
-    	COLOR	intencity(COLOR c, uint8_t n);
-	private:
-    	const	uint8_t sine[17]	= { 127, 139, 152, 164, 176, 187, 198, 208, 217, 225, 233, 239, 244, 249, 252, 253, 254 };
+    	uint8_t		amplitude(uint8_t n);								// sin(PI*n/32) * 127 + 127, the period is 64
+    	uint16_t	amplitude16(uint16_t phase);						// sin(2*PI*phase/65536) * 32767 + 32767, the period is 65536
+    	COLOR		intencity(COLOR c, uint8_t n);
+    	COLOR		intencity16(COLOR c, uint16_t phase);
 };
 
 #endif
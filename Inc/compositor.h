@@ -0,0 +1,53 @@
+#ifndef __COMPOSITOR_H
+#define __COMPOSITOR_H
+#include "animation.h"
+
+/*
+ * The layered compositor runs several animations at once.
+ * Every animation draws in its own layer buffer (see NEOPIXEL::setCanvas()), so it keeps its own state on the strip.
+ * The layers are combined into the strip data array in the order they were added. The first layer is a base layer,
+ * it is copied to the output. Other layers are blended on top of it with the layer mode. The blending works
+ * on the raw buffers word by word, four color components at once.
+ * The LAYER_ALPHA layer with the increasing alpha makes the crossfade from the animation below to the layer one.
+ */
+
+enum e_layer_mode {
+	LAYER_ADD		= 0,											// Saturating addition of the components
+	LAYER_MAX,														// Maximum of the components
+	LAYER_ALPHA,													// Mix the layer with the output by the alpha value
+	LAYER_MULTIPLY													// Multiply the components: the layer is a mask
+};
+typedef enum e_layer_mode LAYER_MODE;
+
+const uint8_t		max_layers	= 3;
+
+class COMPOSITOR {
+	public:
+		COMPOSITOR(void)											{ }
+		bool		addLayer(animation* a, LAYER_MODE mode, uint8_t alpha = 255, bool keep_output = false);
+		void		clear(void)										{ active = 0; }
+		void		truncate(uint8_t n)								{ if (n < active) active = n; }
+		uint8_t		layers(void)									{ return active; }
+		animation*	layerAnimation(uint8_t layer)					{ return (layer < active)?l[layer].a:0; }
+		void		init(void);
+		void		initLayer(uint8_t layer);
+		void		setPeriod(uint8_t layer, uint16_t period);
+		void		setAlpha(uint8_t layer, uint8_t alpha);
+		bool		show(uint32_t ms);
+		void		compose(void);
+	private:
+		bool		stepLayer(uint8_t layer, uint32_t ms);
+		struct s_layer {
+			animation*	a;											// The animation drawing in the layer
+			uint8_t*	buff;										// The layer pixel buffer
+			uint16_t	period;										// The animation step period, ms
+			LAYER_MODE	mode;										// How the layer blends with the layers below
+			uint8_t		alpha;										// The layer opacity: 0 - transparent, 255 - opaque
+		}			l[max_layers];
+		uint8_t*	buff[max_layers]	= { 0 };					// Layer buffers allocated once by malloc()
+		uint16_t	buff_size[max_layers] = { 0 };					// The allocated size of the layer buffers
+		uint8_t		active				= 0;						// The number of active layers
+		bool		dirty				= false;					// The layer parameters changed, the output should be composed
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef __FIRE_H
+#define __FIRE_H
+#include "clrutils.h"
+
+/*
+ * The heat diffusion fire (Fire2012 algorithm by Mark Kriegsman).
+ * The fire is a set of flames. Every flame is a column of heat cells from the origin (cell 0) to the top.
+ * On every step each cell cools down a little, the heat drifts up and diffuses, and the new sparks
+ * ignite near the origin. The heat of the cell is converted to the color by the palette table:
+ * black - red - yellow - white. The table is generated by the compiler and placed in the flash memory.
+ * The random numbers come from the fast 16-bit generator instead of rand(), the division by 3 of the diffusion
+ * is a multiplication and a shift, so every cell takes the fixed number of integer operations.
+ * The heat array is allocated once by malloc() and reused by the next init() if it is large enough.
+ */
+
+class HEAT_LUT {
+	public:
+		constexpr HEAT_LUT(void) : clr() {
+			for (uint16_t i = 0; i < 256; ++i)
+				clr[i] = heatColor(i);
+		}
+		COLOR		operator[](uint8_t heat) const					{ return clr[heat]; }
+	private:
+		static constexpr COLOR heatColor(uint8_t heat) {			// Three thirds of the heat range: red, yellow and white rise
+			uint8_t t192	= (uint16_t(heat) * 192) >> 8;
+			uint8_t ramp	= (t192 & 0x3F) << 2;
+			if (t192 & 0x80)
+				return 0xFFFF00 | ramp;
+			if (t192 & 0x40)
+				return 0xFF0000 | (COLOR(ramp) << 8);
+			return COLOR(ramp) << 16;
+		}
+		COLOR		clr[256];
+};
+
+// The table is local static constant of inline function to have single copy in the flash
+inline const HEAT_LUT& heatLUT(void) {
+	static constexpr HEAT_LUT lut;
+	return lut;
+}
+
+class FIRE {
+	public:
+		FIRE(void)													{ }
+		bool		init(uint8_t flames, uint16_t height);
+		void		setCooling(uint8_t c)							{ cooling = c; }
+		void		setSparking(uint8_t s)							{ sparking = s; }
+		void		step(void);
+		uint8_t		flames(void)									{ return num_flames; }
+		uint16_t	height(void)									{ return cells; }
+		uint8_t		heat(uint8_t flame, uint16_t cell)				{ return h[uint16_t(flame) * cells + cell]; }
+		COLOR		color(uint8_t flame, uint16_t cell)				{ return heatLUT()[heat(flame, cell)]; }
+	private:
+		uint8_t		random8(void) {									// 16-bit linear congruential generator
+			seed = seed * 2053 + 13849;
+			return (seed + (seed >> 8)) & 0xFF;
+		}
+		uint8_t		random8(uint8_t lim)							{ return (uint16_t(random8()) * lim) >> 8; }
+		uint8_t*	h				= 0;							// The heat of the cells, flame by flame
+		uint16_t	allocated		= 0;							// The size of the heat array
+		uint16_t	cells			= 0;							// The number of cells in the flame
+		uint8_t		num_flames		= 0;							// The number of flames
+		uint8_t		cooling			= 55;							// How much the cells cool down: 20 - tall flames, 100 - short flames
+		uint8_t		sparking		= 120;							// The chance (of 255) of the new spark in the flame per step
+		uint16_t	seed			= 0;							// The random generator state
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef __INTERPOLATOR_H
+#define __INTERPOLATOR_H
+#include "animation.h"
+
+/*
+ * The frame interpolation for slow animations.
+ * The animation draws its frames (keyframes) in the separate buffer, then the output is mixed from the previous
+ * output and the new keyframe by the fraction of the step period passed. So the slow animation moves smoothly
+ * at the full refresh rate instead of jumping once per step. The output lags one step behind the animation.
+ * Two buffers of the strip data size are used: the animation keyframe and the output at the last step.
+ */
+
+class INTERPOLATOR {
+	public:
+		INTERPOLATOR(void)											{ }
+		bool		start(void);
+		void		stop(void);
+		bool		active(void)									{ return on; }
+		bool		show(animation* a, uint32_t ms, uint16_t period);
+	private:
+		uint8_t*	key				= 0;							// The keyframe, the animation canvas
+		uint8_t*	prev			= 0;							// The output at the time of the last keyframe
+		uint16_t	allocated		= 0;							// The allocated size of the buffers
+		uint32_t	key_ms			= 0;							// The time of the last keyframe, ms
+		uint16_t	frac			= 0;							// The fraction of the step period passed (0...256)
+		bool		on				= false;						// Whether the interpolation is running
+};
+
+#endif
@@ -3,12 +3,16 @@
 #include "animation.h"
 #include "max7219_cpp.h"
 #include "clean.h"
+#include "compositor.h"
+#include "zones.h"
+#include "interpolator.h"
 
 //---------------------------------------------- Shuffle the animation in the random order --------------------------------
 class shuffle {
 	public:
     	shuffle(uint8_t a_size);
     	uint8_t		next(void);
+    	uint8_t		size(void)								{ return num_anim; }
 	private:
     	void		randomize(void);
     	uint8_t		*index;											// The array of animations, allocated by new()
@@ -17,22 +21,47 @@ class shuffle {
 };
 
 // --------------------------------------------- The sequence manager -----------------------------------------------------
+const uint16_t		interp_period	= 100;						// The animation with longer step period is interpolated, ms
+const uint16_t		pal_period		= 50;						// The palette blending step period, ms
+
 class MANAGER : public shuffle {
 	public:
-    	MANAGER(MAX7219* disp, animation* a[], uint8_t a_size, clr* c[], uint8_t clr_size);
+    	MANAGER(MAX7219* disp, animation* a[], uint8_t a_size, clr* c[], uint8_t clr_size, animation* o[] = 0, uint8_t o_size = 0);
     	void		init(void);
     	void		show(void);
-    	void        menu(void)                              { stp_period --; if (stp_period < 1) stp_period = 1; }
+    	void        menu(void)                              { stp_period --; if (stp_period < 1) stp_period = 1; updatePeriod(); }
     	void        menu_l(void)                            { initClear(); }
-    	void        incr(void)                              { stp_period ++; if (stp_period > 20) stp_period = 20; }
+    	void        incr(void)                              { stp_period ++; if (stp_period > 20) stp_period = 20; updatePeriod(); }
+    	void		incr_l(void)							{ switchFPS(); }
+    	uint16_t	getFPS(void)							{ return fps; }
+    	void		setFadeTime(uint16_t ms)				{ fade_time = ms; }
 	private:
+    	void		nextAnimation(void);
+    	void		setStepPeriod(void);
+    	void		updatePeriod(void)						{ cmp.setPeriod(a_layer, stp_period); zn.setPeriod(0, stp_period); }
+    	bool		initZones(void);
     	void		initClear(void);
+    	void		initFade(void);
+    	void		choosePalette(void);
+    	void		blendPalette(uint32_t ms);
+    	void		fade(uint32_t ms);
+    	void		output(uint32_t ms);
+    	void		switchFPS(void);
     	bool		isClean(void);
     	void		decimal(uint16_t value);
     	MAX7219 	*dsp;
     	animation**	anims;
     	clr**		clearance;
     	uint8_t		num_clr;
+    	animation**	overlays;										// Animations that can run on top of the main one
+    	uint8_t		num_overlays;
+    	COMPOSITOR	cmp;											// Runs the main animation and the overlay or the crossfade in layers
+    	uint8_t		a_layer				= 0;						// The compositor layer of the current animation
+    	ZONES		zn;												// Runs independent animations on the halves of the strip
+    	INTERPOLATOR ip;											// Smooths the slow animation between its steps
+    	PALETTE		palette;										// The palette used by the animations instead of the color wheel
+    	const uint32_t*	pal_target		= 0;						// The gradient the palette is blending to, 0 if the palette is not used
+    	uint32_t	pal_next			= 0;						// The time of the next palette blending step, ms
     	uint32_t	stp;
     	uint16_t	stp_period			= 0;
     	uint16_t	clr_stp_period		= 0;
@@ -41,6 +70,13 @@ class MANAGER : public shuffle {
     	animation*  a 					= 0;
     	clr*		c 					= 0;
     	bool		do_clear;										// Whether cleaning the strip
+    	bool		do_fade				= false;					// Whether crossfading to the next animation
+    	uint32_t	fade_start			= 0;						// The time the crossfade started, ms
+    	uint16_t	fade_time			= 3000;						// The crossfade duration, ms. 0 disables the crossfade
+    	uint32_t	fps_start			= 0;						// The start time of the frame rate measurement, ms
+    	uint16_t	frames				= 0;						// The number of frames since fps_start
+    	uint16_t	fps					= 0;						// The measured frame rate, frames per second
+    	bool		show_fps			= false;					// Whether the display shows the frame rate
 };
 
 #endif
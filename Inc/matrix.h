@@ -0,0 +1,47 @@
+#ifndef __MATRIX_H
+#define __MATRIX_H
+#include "clrutils.h"
+
+/*
+ * The 2D LED panel made of the strip. The pixel coordinates (x, y) are translated to the strip index
+ * by the index table: index = map[y * width + x]. The table is computed once for the standard layouts
+ * or can be supplied by the user for the custom wiring (the table can be placed in the flash).
+ * The point (0, 0) is the top left corner of the panel. All drawing primitives clip the coordinates,
+ * so the shapes can cross the panel border.
+ * The panel is drawn through the strip view (see NEOPIXEL::setView()), so the panel can be a part of the strip.
+ */
+
+enum e_matrix_layout {
+	MATRIX_ROWS			= 0,										// The strip goes along the rows, every row left to right
+	MATRIX_SERPENTINE,												// The strip goes along the rows, even rows left to right, odd rows right to left
+	MATRIX_COLUMNS,													// The strip goes along the columns, every column top to bottom
+	MATRIX_SERP_COLUMNS												// The strip goes along the columns, odd columns bottom to top
+};
+typedef enum e_matrix_layout MATRIX_LAYOUT;
+
+class MATRIX {
+	public:
+		MATRIX(void)												{ }
+		bool		init(uint8_t width, uint8_t height, MATRIX_LAYOUT layout);
+		bool		init(uint8_t width, uint8_t height, const uint16_t *custom_map);
+		uint8_t		width(void)										{ return w; }
+		uint8_t		height(void)									{ return h; }
+		bool		inside(int16_t x, int16_t y)					{ return (x >= 0) && (y >= 0) && (x < w) && (y < h); }
+		uint16_t	XY(uint8_t x, uint8_t y)						{ return map[uint16_t(y) * w + x]; }
+		void		setPixel(int16_t x, int16_t y, COLOR c)			{ if (inside(x, y)) strip.setPixelColor(XY(x, y), c); }
+		COLOR		getPixel(int16_t x, int16_t y)					{ return inside(x, y)?strip.getPixelColor(XY(x, y)):0; }
+		void		fillRect(int16_t x, int16_t y, int16_t width, int16_t height, COLOR c);
+		void		line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, COLOR c);
+		void		blit(int16_t x, int16_t y, uint8_t width, uint8_t height, const COLOR *src);
+	private:
+		bool		clip(int16_t& x, int16_t& y, int16_t& width, int16_t& height);
+		const uint16_t*	map			= 0;							// The index table: width * height entries
+		uint16_t*	own_map			= 0;							// The index table allocated by malloc() for the standard layouts
+		uint16_t	own_size		= 0;							// The number of entries in the allocated table
+		uint8_t		w				= 0;
+		uint8_t		h				= 0;
+};
+
+extern MATRIX		matrix;
+
+#endif
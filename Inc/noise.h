@@ -0,0 +1,44 @@
+#ifndef __NOISE_H
+#define __NOISE_H
+#include "main.h"
+
+/*
+ * The coherent value noise.
+ * The coordinates are fixed point numbers in 1/256 of the lattice cell (Q8.8), the noise repeats every 256 cells.
+ * The lattice points get the pseudo-random values 0...255 from the permutation table, the value between
+ * the lattice points is interpolated with the smoothstep curve, so the noise changes smoothly in space and time.
+ * The permutation table is generated by the compiler and placed in the flash memory.
+ * fractal8() layers the octaves: every next octave has the double frequency and the half amplitude.
+ * Only additions, shifts and 8-bit multiplications are used, no division.
+ */
+
+class NOISE_PERM {
+	public:
+		constexpr NOISE_PERM(void) : p() {							// Shuffle the sequence 0...255 by the fixed generator
+			for (uint16_t i = 0; i < 256; ++i)
+				p[i] = i;
+			uint32_t seed = 0x2F6B3A1D;
+			for (uint16_t i = 255; i > 0; --i) {
+				seed = seed * 1664525 + 1013904223;
+				uint16_t j	= (seed >> 16) % (i + 1);
+				uint8_t  t	= p[i];
+				p[i]		= p[j];
+				p[j]		= t;
+			}
+		}
+		uint8_t		operator[](uint8_t i) const						{ return p[i]; }
+	private:
+		uint8_t		p[256];
+};
+
+// The table is local static constant of inline function to have single copy in the flash
+inline const NOISE_PERM& noisePerm(void) {
+	static constexpr NOISE_PERM perm;
+	return perm;
+}
+
+uint8_t		noise8(uint16_t x);
+uint8_t		noise8(uint16_t x, uint16_t y);
+uint8_t		fractal8(uint16_t x, uint16_t y, uint8_t octaves);
+
+#endif
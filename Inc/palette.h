@@ -0,0 +1,60 @@
+#ifndef __PALETTE_H
+#define __PALETTE_H
+#include "clrutils.h"
+
+/*
+ * The color palettes.
+ * The gradient palette is the compact description of the color gradient placed in the flash memory. It is the array
+ * of the key colors 0xIIRRGGBB, where II is the palette index of the key color. The indexes grow from 0 to 255,
+ * the last entry of the gradient has index 255. The colors between the key colors are interpolated.
+ * The 16-entry palette is 16 colors evenly spread over the index range, the color between two entries is interpolated
+ * by the low 4 bits of the index. The palette wraps around: the last entry is mixed with the first one.
+ * PALETTE is the table of 256 colors in RAM expanded from the gradient or 16-entry palette on demand,
+ * so the color of the index is single table read. The table is allocated once by malloc().
+ * The palette can change smoothly to the other gradient: every blendToward() call moves each color component
+ * of the table toward the target color by the limited amount.
+ */
+
+class PALETTE {
+	public:
+		PALETTE(void)												{ }
+		bool		load(const uint32_t *gradient);
+		bool		load16(const COLOR *pal16);
+		bool		blendToward(const uint32_t *gradient, uint8_t change);
+		bool		isLoaded(void) const							{ return lut != 0; }
+		COLOR		colorFromPalette(uint8_t index, uint8_t brightness = 255) const {
+			COLOR c = lut[index];
+			return (brightness == 255)?c:nscale8(c, brightness);
+		}
+		const COLOR* table(void) const								{ return lut; }
+	private:
+		bool		alloc(void);
+		COLOR*		lut				= 0;							// The palette table, 256 colors
+};
+
+COLOR	colorFromGradient(const uint32_t *gradient, uint8_t index, uint8_t brightness = 255);
+
+// The color of the 16-entry palette, the neighbor entries are interpolated
+static inline COLOR colorFromPalette(const COLOR *pal16, uint8_t index, uint8_t brightness = 255) {
+	uint8_t hi = index >> 4;
+	COLOR c = clrLerp(pal16[hi], pal16[(hi + 1) & 0xF], uint16_t(index & 0xF) << 4);
+	return (brightness == 255)?c:nscale8(c, brightness);
+}
+
+// Built-in gradient palettes
+extern const uint32_t	grad_rainbow[];
+extern const uint32_t	grad_heat[];
+extern const uint32_t	grad_ocean[];
+extern const uint32_t	grad_forest[];
+extern const uint32_t	grad_sunset[];
+extern const uint32_t	grad_meteor[];
+extern const uint32_t*	const gradients[];
+extern const uint8_t	num_gradients;
+
+// Built-in 16-entry palettes
+extern const COLOR		pal16_party[16];
+extern const COLOR		pal16_lava[16];
+extern const COLOR*		const palettes16[];
+extern const uint8_t	num_palettes16;
+
+#endif
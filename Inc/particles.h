@@ -0,0 +1,68 @@
+#ifndef __PARTICLES_H
+#define __PARTICLES_H
+#include "clrutils.h"
+
+/*
+ * The fixed capacity particle pool for the drop-like animations.
+ * The particle data is stored as separate arrays (structure of arrays): the position, the second position,
+ * the color, the velocity and the age. The arrays are allocated once by malloc() and reused by the next init(),
+ * the pool grows only when the larger capacity is requested. The active particles occupy the first size() entries,
+ * so the spawn appends the particle and the kill moves the last particle to the free entry, both are O(1).
+ * The occupancy bitmap has one bit per pixel and answers whether some particle stays in the pixel without
+ * searching the particles. update() rebuilds the bitmap from the particle positions on every pass.
+ * The positions outside the strip are allowed, they are not marked in the bitmap.
+ */
+
+class PARTICLES {
+	public:
+		PARTICLES(void)												{ }
+		bool		init(uint16_t capacity);
+		void		clear(void);
+		uint16_t	size(void)										{ return num; }
+		uint16_t	capacity(void)									{ return cap; }
+		bool		full(void)										{ return num >= cap; }
+		int16_t		spawn(uint16_t p, COLOR c, int8_t v = 0, uint16_t a = 0);
+		void		kill(uint16_t i);
+		bool		occupied(uint16_t p) const {
+			return (p < length) && (map[p >> 5] & (uint32_t(1) << (p & 31)));
+		}
+		/*
+		 * The update pass: call fn(i) for every active particle. The function moves the particle,
+		 * draws it and returns false if the particle should be removed. The removed entry gets the last particle
+		 * that is processed in turn, so the function is called once for every particle
+		 */
+		template <typename UPDATE> void update(UPDATE fn) {
+			clearMap();
+			for (uint16_t i = 0; i < num; ) {
+				if (fn(i)) {
+					mark(pos[i]);
+					++i;
+				} else {
+					remove(i);
+				}
+			}
+		}
+		// The render pass: call fn(i) for every active particle, the particles are not changed
+		template <typename RENDER> void render(RENDER fn) const {
+			for (uint16_t i = 0; i < num; ++i) fn(i);
+		}
+		uint16_t*	pos				= 0;							// The particle position, pixel
+		uint16_t*	aux				= 0;							// The second position or any animation specific value
+		COLOR*		color			= 0;							// The particle color
+		int8_t*		vel				= 0;							// The velocity, pixels per step
+		uint8_t*	age				= 0;							// The number of steps since spawn
+	private:
+		void		remove(uint16_t i);
+		void		clearMap(void);
+		void		mark(uint16_t p) {
+			if (p < length) map[p >> 5] |= uint32_t(1) << (p & 31);
+		}
+		uint32_t*	map				= 0;							// The occupancy bitmap, one bit per pixel
+		uint16_t	map_words		= 0;							// The allocated bitmap size, 32-bit words
+		uint16_t	length			= 0;							// The number of pixels tracked by the bitmap
+		uint16_t	cap				= 0;							// The pool capacity
+		uint16_t	allocated		= 0;							// The number of entries allocated
+		uint16_t	num				= 0;							// The number of active particles
+};
+
+#endif
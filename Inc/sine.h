@@ -0,0 +1,135 @@
+#ifndef __SINE_H
+#define __SINE_H
+#include "main.h"
+
+/*
+ * Sine tables and easing curves.
+ * The sine tables are generated by the compiler and placed in the flash memory, no run-time initialization is required.
+ * The table keeps a quarter of the period only: steps/4 + 1 values of round(max * sin(2*PI*i/steps)),
+ * other three quarters are folded to the first one.
+ * The resolution is configurable: steps per period should be a power of two (256 or 1024),
+ * the amplitude can be 8-bit (int8_t, max = 127) or 16-bit (int16_t, max = 32767).
+ */
+
+#ifndef SINE_STEPS
+#define SINE_STEPS	1024											// Steps per period of the high resolution table used by sin16()
+#endif
+#if (SINE_STEPS != 256) && (SINE_STEPS != 1024)
+#error "SINE_STEPS should be 256 or 1024"
+#endif
+
+template <uint16_t steps, typename T>
+class SINE_LUT {
+	public:
+		constexpr SINE_LUT(void) : q() {
+			const double max = (sizeof(T) == 1)?127.0:32767.0;
+			for (uint16_t i = 0; i <= steps/4; ++i)
+				q[i] = T(sine(HALF_PI * i / (steps/4)) * max + 0.5);
+		}
+		T			operator()(uint16_t phase) const {				// The value in the phase (0 <= phase < steps)
+			phase &= steps - 1;
+			uint16_t i = phase & (steps/4 - 1);
+			if (phase & (steps/4)) i = steps/4 - i;					// Second and fourth quarters are mirrored
+			if (phase & (steps/2)) return -q[i];					// Second half of the period is negative
+			return q[i];
+		}
+	private:
+		static constexpr double HALF_PI = 1.5707963267948966;
+		static constexpr double sine(double x) {					// Taylor series, 0 <= x <= PI/2
+			double term = x, sum = x;
+			for (uint8_t n = 2; n < 24; n += 2) {
+				term *= -x * x / (n * (n + 1));
+				sum  += term;
+			}
+			return sum;
+		}
+		T			q[steps/4 + 1];
+};
+
+typedef SINE_LUT<256, int8_t>			SINE8;						// 256 steps, 8-bit
+typedef SINE_LUT<SINE_STEPS, int16_t>	SINE16;						// SINE_STEPS steps, 16-bit
+
+// The tables are local static constants of inline functions to have single copy of each one in the flash
+inline const SINE8& sine8LUT(void) {
+	static constexpr SINE8 lut;
+	return lut;
+}
+
+inline const SINE16& sine16LUT(void) {
+	static constexpr SINE16 lut;
+	return lut;
+}
+
+// sin(2*PI*angle/256) * 127, the period is 256
+inline int8_t sin8(uint8_t angle) {
+	return sine8LUT()(angle);
+}
+
+// sin(2*PI*angle/65536) * 32767, the period is 65536. The values between table entries are interpolated linearly
+inline int16_t sin16(uint16_t angle) {
+	const uint8_t	shift	= (SINE_STEPS == 256)?8:6;				// 16 bits of the angle minus bits of the table index
+	uint16_t		i		= angle >> shift;
+	int32_t			frac	= angle & ((1 << shift) - 1);
+	int32_t			a		= sine16LUT()(i);
+	int32_t			b		= sine16LUT()(i + 1);
+	return a + (((b - a) * frac) >> shift);
+}
+
+// cos(2*PI*angle/65536) * 32767
+inline int16_t cos16(uint16_t angle) {
+	return sin16(angle + 16384);
+}
+
+/*
+ * Easing curves: the input is the progress 0...255, the output is the eased progress 0...255
+ * The curve starts at 0 and ends at 255. 'In' curves accelerate, 'Out' curves decelerate, 'InOut' do both
+ */
+inline uint8_t ease8InQuad(uint8_t x) {
+	return (uint16_t(x) * (uint16_t(x) + 1)) >> 8;
+}
+
+inline uint8_t ease8OutQuad(uint8_t x) {
+	return 255 - ease8InQuad(255 - x);
+}
+
+inline uint8_t ease8InOutQuad(uint8_t x) {
+	uint8_t j = x;
+	if (j & 0x80) j = 255 - j;
+	j = ease8InQuad(j << 1) >> 1;									// The first half of the curve is squeezed twice
+	if (x & 0x80) j = 255 - j;
+	return j;
+}
+
+inline uint8_t ease8InCubic(uint8_t x) {
+	uint32_t t = x + (x >> 7);										// 0...256
+	uint32_t r = (t * t * t) >> 16;
+	if (r > 255) r = 255;
+	return r;
+}
+
+inline uint8_t ease8OutCubic(uint8_t x) {
+	return 255 - ease8InCubic(255 - x);
+}
+
+inline uint8_t ease8InOutCubic(uint8_t x) {
+	uint32_t t = x + (x >> 7);										// 0...256
+	uint32_t r = (3 * (t * t << 8) - 2 * t * t * t) >> 16;			// 3t^2 - 2t^3, computed in full precision to keep the curve monotonic
+	if (r > 255) r = 255;
+	return r;
+}
+
+inline uint8_t ease8InSine(uint8_t x) {
+	uint32_t r = 32767 - sin16(16384 + (x << 6) + (x >> 2));		// (1 - cos(PI/2*x/255)) * 32767, the high resolution table
+	return (r * 255 + 16383) / 32767;
+}
+
+inline uint8_t ease8OutSine(uint8_t x) {
+	return 255 - ease8InSine(255 - x);
+}
+
+inline uint8_t ease8InOutSine(uint8_t x) {
+	uint8_t r = 127 - sin8(64 + (x >> 1));							// (1 - cos(PI*x/256)) * 127
+	return r + (r >> 7);											// Stretch 0...254 to 0...255
+}
+
+#endif
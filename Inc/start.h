@@ -14,6 +14,15 @@ void loop(void);
 
 #ifdef __cplusplus
 }
+
+// The animation and the clearance lists, see start.cpp
+#include <stdint.h>
+class animation;
+class clr;
+extern animation*		anims[];
+extern const uint8_t	num_anim;
+extern clr*				clearance[];
+extern const uint8_t	num_clr;
 #endif
 
 #endif
@@ -0,0 +1,61 @@
+#ifndef __TREE3D_H
+#define __TREE3D_H
+#include "clrutils.h"
+
+/*
+ * The LED coordinates of the tree installation.
+ * Every LED has the cylindrical coordinates: height (0 - bottom, 255 - top), angle (0...255 is a full turn)
+ * and radius (0 - trunk, 255 - the widest place). The coordinate table is constant, so it is placed in the flash.
+ * The table can be generated by the compiler for the string wrapped around the cone as a spiral (see TREE_SPIRAL)
+ * or it can be measured and included from the file as a list of { height, angle, radius }, entries.
+ * The Cartesian coordinates x and y (-127...127) are derived from the angle and radius by the sine table.
+ * The spatial primitives return the intensity of the LED (0...255) for the moving shape, they use integer math only.
+ */
+
+struct s_led_pos {
+	uint8_t		h;													// The height
+	uint8_t		a;													// The angle
+	uint8_t		r;													// The radius
+};
+typedef struct s_led_pos LED_POS;
+
+// The spiral of 'leds' LEDs wrapped around the cone, 'turns' turns from the bottom to the top
+template <uint16_t leds, uint8_t turns>
+class TREE_SPIRAL {
+	public:
+		constexpr TREE_SPIRAL(void) : p() {
+			for (uint16_t i = 0; i < leds; ++i) {
+				uint8_t h = (uint32_t(i) * 255) / ((leds > 1)?(leds - 1):1);
+				p[i].h = h;
+				p[i].a = (uint32_t(i) * turns * 256 / leds) & 0xFF;
+				p[i].r = 255 - h;									// The cone narrows to the top
+			}
+		}
+		constexpr const LED_POS* map(void) const				{ return p; }
+		constexpr uint16_t size(void) const					{ return leds; }
+	private:
+		LED_POS		p[leds];
+};
+
+class TREE3D {
+	public:
+		TREE3D(void)												{ }
+		void		init(const LED_POS *map, uint16_t size)			{ pos = map; leds = size; }
+		uint16_t	numPixels(void);
+		uint8_t		height(uint16_t n)								{ return pos[n].h; }
+		uint8_t		angle(uint16_t n)								{ return pos[n].a; }
+		int8_t		x(uint16_t n)									{ return (int16_t(pos[n].r) * sin8(pos[n].a + 64)) >> 8; }
+		int8_t		y(uint16_t n)									{ return (int16_t(pos[n].r) * sin8(pos[n].a)) >> 8; }
+		uint8_t		plane(uint16_t n, uint8_t level, uint16_t fall);
+		uint8_t		beam(uint16_t n, uint8_t direction, uint16_t fall);
+		uint8_t		sphere(uint16_t n, int8_t cx, int8_t cy, uint8_t ch, uint16_t radius, uint16_t fall);
+		static uint16_t	falloff(uint8_t width);
+	private:
+		uint8_t		intensity(uint16_t distance, uint16_t fall);
+		const LED_POS*	pos		= 0;								// The LED coordinate table
+		uint16_t	leds		= 0;								// The number of LEDs in the table
+};
+
+extern TREE3D		tree;
+
+#endif
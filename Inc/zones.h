@@ -0,0 +1,32 @@
+#ifndef __ZONES_H
+#define __ZONES_H
+#include "animation.h"
+
+/*
+ * The strip zones run independent animations on the ranges of one strip, for example, on the layers of the tree.
+ * Every animation draws through its own view (see NEOPIXEL::setView()), so it sees the zone as a whole strip.
+ * The animations draw directly in the strip data array, no additional buffer is used.
+ */
+
+const uint8_t		max_zones	= 3;
+
+class ZONES {
+	public:
+		ZONES(void)													{ }
+		bool		addZone(animation* a, uint16_t offset, uint16_t length, uint8_t flags = 0);
+		void		clear(void)										{ active = 0; }
+		uint8_t		zones(void)										{ return active; }
+		void		init(void);
+		void		setPeriod(uint8_t zone, uint16_t period);
+		bool		show(uint32_t ms);
+		bool		complete(void);
+	private:
+		struct s_zone {
+			animation*		a;										// The animation running in the zone
+			PIXEL_SURFACE	view;									// The range of the strip
+			uint16_t		period;									// The animation step period, ms
+		}			z[max_zones];
+		uint8_t		active				= 0;						// The number of active zones
+};
+
+#endif
@@ -8,6 +8,51 @@ animation::animation(void) {
 	show_time	= min_time / 10;
 	do_clear 	= false;
 	complete 	= true;
+	spatial		= false;
+}
+
+/*
+ * Run the animation till the time ms, returns true if the strip has been changed.
+ * The animation makes one step per period. The steps delayed by the slow frames are caught up,
+ * so the animation speed does not depend on the frame rate. The time based animations override this method
+ * to compute the state from the time
+ */
+bool animation::advance(uint32_t ms, uint16_t period) {
+	if (!time_set) startTime(ms);
+	if (period == 0) period = 1;
+	if (int32_t(ms - next_step) < 0) return false;
+	for (uint8_t s = 0; s < max_catch_up && int32_t(ms - next_step) >= 0; ++s) {
+		show();
+		next_step += period;
+	}
+	if (int32_t(ms - next_step) >= 0)								// The frame is too slow, skip the missed steps
+		next_step = ms + period;
+	return true;
+}
+
+// The time since the previous call, ms. The first call after resetTime() returns 0
+uint32_t animation::timeDelta(uint32_t ms) {
+	if (!time_set) startTime(ms);
+	uint32_t dt = ms - last_ms;
+	last_ms = ms;
+	return dt;
+}
+
+// The number of steps made since the previous call in 1/256 step units. The division remainder is kept for the next call
+uint32_t animation::timeSteps(uint32_t ms, uint16_t period) {
+	if (period == 0) period = 1;
+	uint32_t dt = timeDelta(ms);
+	if (dt > 1000) dt = 1000;										// The animation has been paused
+	uint32_t s	= (dt << 8) + step_rem;
+	step_rem	= s % period;
+	return s / period;
+}
+
+void animation::startTime(uint32_t ms) {
+	time_set	= true;
+	next_step	= ms;
+	last_ms		= ms;
+	step_rem	= 0;
 }
 
 // --------------------------------------------- Fill the dots one after the other with a color ---------------------------
@@ -20,7 +65,7 @@ void colorWipe::init(void) {
 }
 
 void colorWipe::show(void) {
-	uint32_t color = strip.wheel(w);
+	uint32_t color = wheel(w);
 	if (fwd) {
 		if (index > int(strip.numPixels())) {						// Start new sequence with the new color
 			init();
@@ -54,7 +99,7 @@ void colorWalk::show(void) {
 			index -= period;
 			strip.setPixelColor(n-1, 0);
 		}
-		uint32_t color = strip.wheel(w--);
+		uint32_t color = wheel(w--);
 		for (int i = index; i > 0; i -= period) {
 			if (i > 0) strip.setPixelColor(i-1, 0);
 			strip.setPixelColor(i, color);
@@ -65,7 +110,7 @@ void colorWalk::show(void) {
 			index += period;
 			strip.setPixelColor(0, 0);
 		}
-		uint32_t color = strip.wheel(w++);
+		uint32_t color = wheel(w++);
 		for (int i = index; i < n; i += period) {
 			if (i < int(strip.numPixels() - 1)) strip.setPixelColor(i+1, 0);
 			strip.setPixelColor(i, color);
@@ -92,7 +137,7 @@ void randomCreep::show(void) {
 	++cnt;
 	if (cnt > space) {
 		cnt = 0;
-		next_color = strip.wheel(Random(256));
+		next_color = wheel(Random(256));
 	}
 	step();
 }
@@ -100,6 +145,7 @@ void randomCreep::show(void) {
 // --------------------------------------------- show the color Wave using rainbowCycle -----------------------------------
 void colorWave::init(void) {
 	index = 0;
+	steps = 0;
 	rdy = false;
 	fwd = Random(2);
 }
@@ -108,18 +154,39 @@ void colorWave::show(void) {
 	if (!rdy) {
 		rdy = true;
 		for (uint16_t i = 0; i < strip.numPixels(); ++i) {
-			setColor(strip.wheel(((i * 256 / strip.numPixels())) & 255));
+			setColor(wheel(((i * 256 / strip.numPixels())) & 255));
 			if (!change(i, 2)) rdy = false;
 		}
 		return;
 	}
 
+	if (strip.isIndexed()) {									// The wave moves by the palette rotation
+		strip.setPaletteShift(++index);
+		return;
+	}
 	step();
 	if (fwd)
-		strip.setPixelColor(0, strip.wheel(index & 255));
+		strip.setPixelColor(0, wheel(index & 255));
 	else
-		strip.setPixelColor(strip.numPixels() - 1, strip.wheel(index & 255));
+		strip.setPixelColor(strip.numPixels() - 1, wheel(index & 255));
 	++index;
+	if (steps < strip.numPixels())
+		++steps;
+	else
+		startIndexed();
+}
+
+/*
+ * When the first colors crawled out of the strip, the pixel i has the color wheel(index - 1 - i) counting from
+ * the start of the wave. So the next steps just rotate the palette of the indexed strip
+ */
+bool colorWave::startIndexed(void) {
+	if (!strip.setIndexed(wheelTable())) return false;
+	uint16_t n = strip.numPixels();
+	for (uint16_t i = 0; i < n; ++i)
+		strip.setPixelIndex(fwd?i:n - 1 - i, 255 - (i & 255));
+	strip.setPaletteShift(index);
+	return true;
 }
 
 // --------------------------------------------- show the rainbow (from the NEOPIXEL example) -----------------------------
@@ -127,16 +194,44 @@ void rainbow::show(void) {
 	if (!rdy) {
 		rdy = true;
 		for (uint16_t i = 0; i < strip.numPixels(); ++i) {
-			setColor(strip.wheel(i & 255));
+			setColor(wheel(i & 255));
 			if (!change(i, 2)) rdy = false;
 		}
 		return;
 	}
 
+	draw();
+	++index;													// index is from 0 to 255
+}
+
+// The rainbow moves with the constant speed: one color wheel index per period
+bool rainbow::advance(uint32_t ms, uint16_t period) {
+	uint32_t s = timeSteps(ms, period);
+	if (!rdy) {													// Light up the rainbow step by step
+		bool changed = animation::advance(ms, period);
+		phase = uint16_t(index) << 8;							// The steps can move the rainbow after it lit up
+		return changed;
+	}
+	phase += s;
+	if ((phase >> 8) == index) return false;
+	index = phase >> 8;
+	draw();
+	return true;
+}
+
+// The indexed strip keeps the rainbow, the palette rotation moves it
+void rainbow::draw(void) {
+	if (!strip.isIndexed() && strip.setIndexed(wheelTable())) {
+		for (uint16_t i = 0; i < strip.numPixels(); ++i)
+			strip.setPixelIndex(i, i & 255);
+	}
+	if (strip.isIndexed()) {
+		strip.setPaletteShift(index);
+		return;
+	}
 	for(uint16_t i = 0; i < strip.numPixels(); ++i) {
-		strip.setPixelColor(i, strip.wheel((i+index) & 255));
+		strip.setPixelColor(i, wheel((i+index) & 255));
 	}
-	++index;													// index is from 0 to 255
 }
 
 // --------------------------------------------- show the rainbowCycle (from the NEOPIXEL example) ------------------------
@@ -144,16 +239,42 @@ void rainCycle::show(void) {
 	if (!rdy) {
 		rdy = true;
 		for (uint16_t i = 0; i < strip.numPixels(); ++i) {
-			setColor(strip.wheel((i * 256 / strip.numPixels()) & 255));
+			setColor(wheel((i * 256 / strip.numPixels()) & 255));
 			if (change(i, 1)) rdy = false;
 		}
 		return;
 	}
 
+	draw();
+	++index;													// index is from 0 to 255
+}
+
+bool rainCycle::advance(uint32_t ms, uint16_t period) {
+	uint32_t s = timeSteps(ms, period);
+	if (!rdy) {													// Light up the rainbow step by step
+		bool changed = animation::advance(ms, period);
+		phase = uint16_t(index) << 8;							// The steps can move the rainbow after it lit up
+		return changed;
+	}
+	phase += s;
+	if ((phase >> 8) == index) return false;
+	index = phase >> 8;
+	draw();
+	return true;
+}
+
+void rainCycle::draw(void) {
+	if (!strip.isIndexed() && strip.setIndexed(wheelTable())) {
+		for (uint16_t i = 0; i < strip.numPixels(); ++i)
+			strip.setPixelIndex(i, (i * 256 / strip.numPixels()) & 255);
+	}
+	if (strip.isIndexed()) {
+		strip.setPaletteShift(index);
+		return;
+	}
 	for(uint16_t i = 0; i < strip.numPixels(); ++i) {
-		strip.setPixelColor(i, strip.wheel(((i * 256 / strip.numPixels()) + index) & 255));
+		strip.setPixelColor(i, wheel(((i * 256 / strip.numPixels()) + index) & 255));
 	}
-	++index;													// index is from 0 to 255
 }
 
 // --------------------------------------------- show the rainbow colors on the entire strip ------------------------------
@@ -161,21 +282,33 @@ void rainFull::show(void) {
 	if (!rdy) {
 		rdy = true;
 		for (uint16_t i = 0; i < strip.numPixels(); ++i) {
-			setColor(strip.wheel(index));
+			setColor(wheel(index));
 			if (!change(i, 1)) rdy = false;
 		}
 		return;
 	}
 
 	for (uint16_t i = 0; i < strip.numPixels(); ++i) {
-		strip.setPixelColor(i, strip.wheel(index));
+		strip.setPixelColor(i, wheel(index));
 	}
 	++index;													// index is from 0 to 255
 }
 
 //---------------------------------------------- Light up with the aRandom color than fade out -----------------------------
+// The strip lights up and fades out by the value of HSV color, the hue and saturation do not change
 void lightUp::show(void) {
-	bool finish = changeAll(inc);
+	bool finish;
+	if (inc > 0) {													// Increment the value by inc/256 of the maximum, at least by 1
+		uint8_t d	= inc;
+		val			= (255 - val > d)?val + d:255;
+		finish		= (val == 255);
+	} else {														// Decrement the value by -inc/256 of the value, at least by -inc
+		uint8_t v	= scale8(val, 255 + inc);
+		if (v == val) v = (val > -inc)?val + inc:0;
+		val			= v;
+		finish		= (val == 0);
+	}
+	strip.fillHSV(0, strip.numPixels(), uint16_t(hue) << 8, hue_step, sat, val);
 	if (finish) {
 		if (inc > 0) {
 			inc = -8;
@@ -190,29 +323,35 @@ void lightUp::show(void) {
 	}
 }
 
+// The random hue, the pale colors are possible. The hue can slightly change along the strip
 void lightUp::newColor(void) {
-	uint32_t c = 0;
-	for (uint8_t i = 0; i < 3; ++i) {
-		c <<= 8;
-		uint8_t d = Random(16) << 4;
-		c |= d;
-	}
-	setColor(c);
+	hue			= Random(256);
+	sat			= Random(128, 256);
+	hue_step	= (int16_t(Random(65)) - 32) * 256 / int16_t(strip.numPixels());
 }
 
 //---------------------------------------------- Random sparcs ------------------------------------------------------------
+void sparks::init(void) {
+	uint16_t rate = (strip.numPixels() >> 7) + 1;						// New sparks per step, more sparks on the long strip
+	pt.init(rate * 7);
+}
+
 void sparks::show(void) {
-	uint32_t c = strip.wheel(Random(256));
-	for (int8_t i = 7; i >= 1; --i) {
-		if (i == 6)
-			strip.setPixelColor(pos[uint8_t(i)], 0);
-		else
-			change(pos[uint8_t(i)], -128);
-		pos[uint8_t(i)] = pos[uint8_t(i-1)];
+	pt.update([this](uint16_t i) {
+		if (++pt.age[i] >= 7) {											// The spark is old enough, switch it off
+			strip.setPixelColor(pt.pos[i], 0);
+			return false;
+		}
+		change(pt.pos[i], -128);
+		return true;
+	});
+	uint16_t rate = (strip.numPixels() >> 7) + 1;						// New sparks per step, the sparks of a step go out together
+	for (uint16_t s = 0; s < rate && !pt.full(); ++s) {
+		uint16_t p = Random(strip.numPixels()+1);
+		COLOR c = wheel(Random(256));
+		pt.spawn(p, c);
+		strip.setPixelColor(p, c);
 	}
-	int16_t p = Random(strip.numPixels()+1);
-	pos[0] = p;
-	strip.setPixelColor(p, c);
 }
 
 //---------------------------------------------- Random sparks fade out ---------------------------------------------------
@@ -221,7 +360,7 @@ void rndFade::show(void) {
 	uint8_t newDot = Random(1, 5);
 	for (uint8_t i = 0; i < newDot; ++i) {
 		uint16_t p		= Random(strip.numPixels()+1);
-		uint32_t c		= strip.wheel(Random(256));
+		uint32_t c		= wheel(Random(256));
 		if (strip.getPixelColor(p) == 0)
 			strip.setPixelColor(p, c);
 	}
@@ -229,7 +368,7 @@ void rndFade::show(void) {
 
 //---------------------------------------------- Lights run from the center -----------------------------------------------
 void centerRun::init(void) {
-	color		= strip.wheel(Random(256));
+	color		= wheel(Random(256));
 	int n		= strip.numPixels();
 	int diff	= n >> 3;
 	m = l = r = Random(diff+2) + ((n * 7) >> 4);
@@ -241,7 +380,7 @@ void centerRun::show(void) {
 	l -= 2; r += 2;
 	if ((l < 0) && r >= int(strip.numPixels())) {
 		l = r = m + 1;
-		color = strip.wheel(Random(256));
+		color = wheel(Random(256));
 	}
 }
 
@@ -269,7 +408,7 @@ void shineSeven::show() {
 }
 
 void shineSeven::startNewColor(void) {
-	uint32_t c = strip.wheel(w);
+	uint32_t c = wheel(w);
 	w += 97;
 	setColor(c);
 	c &= 0x10101;
@@ -290,7 +429,7 @@ void walkSeven::show(void) {
 	changeAll(-64);
 
 	int n = strip.numPixels();
-	uint32_t c1 = strip.wheel(w);
+	uint32_t c1 = wheel(w);
 	w += 71;
 	for (int i = curs; i < n; i += period) {
 		uint32_t c2 = strip.getPixelColor(i);
@@ -327,7 +466,7 @@ void flashSeven::show(void) {
 	if (fwd) ++curs; else --curs;
 	curs %= period;
 
-	uint32_t c = strip.wheel(w);
+	uint32_t c = wheel(w);
 	w += 71;
 	for (int i = curs; i < n; i += period) {
 		strip.setPixelColor(i, c);
@@ -344,9 +483,9 @@ void mergeOne::init(void) {
 	l 	= 0;
 	r 	= strip.numPixels();
 	uint8_t indx = Random(256);
-	cl 	= strip.wheel(indx);
+	cl 	= wheel(indx);
 	indx += Random(4, 16);
-	cr 	= strip.wheel(indx);
+	cr 	= wheel(indx);
 	strip.clear();
 }
 
@@ -383,16 +522,16 @@ void mergeWave::init(void) {
 
 void mergeWave::show(void) {
 	if (l < r) {
-		strip.setPixelColor(l, strip.wheel(l & 255));
+		strip.setPixelColor(l, wheel(l & 255));
 		if (l > len) strip.setPixelColor(l-len, 0);
-		strip.setPixelColor(r, strip.wheel((index + r) & 255));
+		strip.setPixelColor(r, wheel((index + r) & 255));
 		if ((r + len) > int(strip.numPixels())) strip.setPixelColor(r+len, 0);
 	} else {
 		uint32_t c = strip.getPixelColor(l);
-		c |= strip.wheel(l & 255);
+		c |= wheel(l & 255);
 		strip.setPixelColor(l, c);
 		c = strip.getPixelColor(r);
-		c |= strip.wheel((index + r) & 255);
+		c |= wheel((index + r) & 255);
 		strip.setPixelColor(r, c);
 		strip.setPixelColor(l-len, 0);
 		strip.setPixelColor(r+len, 0);
@@ -410,9 +549,9 @@ void collideOne::init(void) {
 	l = 0;
 	r = strip.numPixels() - 1;
 	uint8_t w = Random(256);
-	cl = strip.wheel(w);
+	cl = wheel(w);
 	w += Random(8, 16);
-	cr = strip.wheel(w);
+	cr = wheel(w);
 	strip.clear();
 	boom = false;
 }
@@ -443,37 +582,44 @@ void collideOne::show(void) {
 	complete = false;
 }
 
-//---------------------------------------------- Neo fire animation by Robert Ulbricht ----------------------------------
+//---------------------------------------------- The flames rise from several origins along the strip -------------------
+/*
+ * The strip is split into the equal parts, one flame in each part. The flames in the even parts rise up the strip,
+ * the flames in the odd parts rise down, so two neighbor flames share the origin or the top
+ */
 void neoFire::init(void) {
-	color = 0;
-	uint8_t m = Random(3);
-	color |= c1 << (m*8);
-	m += Random(1,3);
-	if (m >= 3) m = 0;
-	color |= c2 << (m*8);
+	uint16_t n			= strip.numPixels();
+	uint8_t  max_flames	= constrain(n / 25, 1, 4);
+	uint8_t  flames		= Random(1, max_flames+1);
+	fire.init(flames, (n + flames - 1) / flames);
+	fire.setCooling(Random(40, 80));
+	fire.setSparking(Random(80, 160));
+	rotate	= Random(4);												// Red fire is more probable
+	if (rotate > 2) rotate = 0;
 }
 
 void neoFire::show(void) {
-	if (pause > 0) {
-		--pause;
-		return;
-	}
-	pause = Random(8);
-	for (uint16_t i = 0; i < strip.numPixels(); ++i) {
-		uint32_t blended_color = add(strip.getPixelColor(i), color);
-		uint8_t r = Random(80);
-		uint32_t diff_color = strip.Color(r, r/2, r/2);
-		blended_color = sub(blended_color, diff_color);
-		strip.setPixelColor(i, blended_color);
+	fire.step();
+	uint16_t n		= strip.numPixels();
+	uint16_t cells	= fire.height();
+	uint16_t i		= 0;
+	for (uint8_t f = 0; f < fire.flames() && i < n; ++f) {
+		uint16_t len = (n - i < cells)?n - i:cells;						// The last part can be shorter
+		for (uint16_t c = 0; c < len; ++c, ++i) {
+			COLOR color = fire.color(f, (f & 1)?len - 1 - c:c);
+			if (rotate)
+				color = ((color >> (8 * rotate)) | (color << (24 - 8 * rotate))) & 0xFFFFFF;
+			strip.setPixelColor(i, color);
+		}
 	}
 }
 
 //---------------------------------------------- Even and odd position leds are moving towards each other ---------------
 void evenOdd::init(void) {
 	uint8_t indx = Random(256);
-	cl = strip.wheel(indx);
+	cl = wheel(indx);
 	indx += Random(4, 16);
-	cr = strip.wheel(indx);
+	cr = wheel(indx);
 	l = 0;
 	r = strip.numPixels() - 1;											// r is Odd
 }
@@ -557,8 +703,8 @@ void collMdl::show(void) {
 }
 
 void collMdl::newColors(void) {
-	cl = strip.wheel(Random(256));
-	cr = strip.wheel(Random(256));
+	cl = wheel(Random(256));
+	cr = wheel(Random(256));
 	l = 0;
 	r = strip.numPixels() - 1;
 }
@@ -605,8 +751,8 @@ void collEnd::show(void) {
 }
 
 void collEnd::newColors(void) {
-	cl = strip.wheel(Random(256));
-	cr = strip.wheel(Random(256));
+	cl = wheel(Random(256));
+	cr = wheel(Random(256));
 	l = mr;
 	r = ml;
 }
@@ -614,7 +760,7 @@ void collEnd::newColors(void) {
 //------------------------------------------- Rainbow colors blend --------------------------------------------------------
 void rainBlend::show(void) {
 	if (index < int(strip.numPixels())) {
-		strip.setPixelColor(index, strip.wheel(((index * 256 / strip.numPixels())) & 255));
+		strip.setPixelColor(index, wheel(((index * 256 / strip.numPixels())) & 255));
 		++index;
 		return;
 	}
@@ -626,7 +772,7 @@ void rainBlend::show(void) {
 void swing::init(void) {
 	len = 1;
 	w = Random(256);
-	COLOR c = strip.wheel(w);
+	COLOR c = wheel(w);
 	strip.setPixelColor(0, c);
 	fwd			= true;
 	next_color	= 0;
@@ -639,7 +785,7 @@ void swing::show(void) {
 
 	if (index < 0) {											// Run out from the strip
 		w += Random(3, 10);
-		COLOR c = strip.wheel(w);
+		COLOR c = wheel(w);
 		if (fwd)
 			strip.setPixelColor(strip.numPixels() - len - 1, c);
 		else
@@ -660,7 +806,7 @@ void swing::show(void) {
 void swingSingle::init(void) {
 	len		= 1;
 	w		= Random(256);
-	color	= strip.wheel(w);
+	color	= wheel(w);
 	fwd		= true;
 	index	= len;
 	strip.setPixelColor(0, color);
@@ -733,9 +879,9 @@ void randomFill::show() {
 	}
 
 	// Blend active pixels
-	COLOR color = strip.wheel(w);
+	COLOR color = wheel(w);
 	for (uint16_t i = 0; i < strip.numPixels(); ++i) {
-		if (i != pos && strip.getPixelColor(i) != 0) {
+		if (i != pos && strip.isLit(i)) {
 			strip.setPixelColor(i, color);								// Restore original color to disable huge deviation
 			blendPixel(i, 10);
 		}
@@ -745,23 +891,13 @@ void randomFill::show() {
 
 void randomFill::newDot(bool clr) {
 	COLOR color = 0;
-	if (!clr) color = strip.wheel(w);
-
-	uint8_t p = Random(remain);
-	uint8_t c = 0;
-	for (pos = 0; (pos < strip.numPixels()) && (c < p); ++pos) {
-		if (!color) {
-			while(strip.getPixelColor(pos) == 0) pos++;
-			++c;
-		} else {
-			while(strip.getPixelColor(pos) != 0) pos++;
-			++c;
-		}
-	}
-	if (!color) {
-		while(strip.getPixelColor(pos) == 0) pos++;
-	} else {
-		while(strip.getPixelColor(pos) != 0) pos++;
+	if (!clr) color = wheel(w);
+
+	uint16_t p = Random(remain);
+	if (!color) {														// Select the p-th lit pixel to be cleared
+		pos = strip.litPixel(p);
+	} else {															// Select the p-th black pixel to be lit
+		pos = strip.unlitPixel(p);
 	}
 	if (pos >= strip.numPixels()) {									// something is wrong in the code
 		for (uint16_t i = 0; i < strip.numPixels(); ++i)
@@ -833,7 +969,7 @@ void shineFlash::show() {
 }
 
 void shineFlash::startNewColor(void) {
-	COLOR c = strip.wheel(w);
+	COLOR c = wheel(w);
 	c &= 0x7f7f7f;
 	w += 17;
 	setColor(c);
@@ -845,7 +981,7 @@ void shineFlash::startNewColor(void) {
 
 //---------------------------------------------- Show single wave moving in Random direction ------------------------------
 void singleWave::init(void) {
-	COLOR c = strip.wheel(Random(256));
+	COLOR c = wheel(Random(256));
 	uint32_t r = c & 0xff;
 	uint32_t g = (c >> 8)  & 0xff;
 	uint32_t b = (c >> 16) & 0xff;
@@ -925,7 +1061,8 @@ void singleWave::show() {
 
 //---------------------------------------------- Several worms are moving Randomly ---------------------------------------
 void worms::init(void) {
-	active   = 0;
+	uint16_t n = strip.numPixels() / 20;
+	pt.init((n > 5)?n:5);
 	add();
 }
 
@@ -936,82 +1073,94 @@ void worms::show(void) {
 	changeAll(-32);
 
 	// Move existing
-	for (uint8_t wi = 0; wi < active; ++wi) {
-		int np = w[wi].pos - 1;
-		if (w[wi].fwd) np += 2;
-		if ((np < 0) || (np >= n)) {
-			die(wi);
-			--wi;
-			continue;
-		}
+	pt.update([this, n](uint16_t i) {
+		int np = pt.pos[i] + pt.vel[i];
+		if ((np < 0) || (np >= n))
+			return false;
 		COLOR c = strip.getPixelColor(np);
-		if ((c != 0) && (Random(10) == 0)) {
-			die(wi);
-			--wi;
-			continue;
-		} else {
-			c = TWOCLR::add(c, w[wi].color);
-			w[wi].pos = np;
-			strip.setPixelColor(np, c);
-		}
-	}
+		if ((c != 0) && (Random(10) == 0))
+			return false;
+		c = TWOCLR::add(c, pt.color[i]);
+		pt.pos[i] = np;
+		strip.setPixelColor(np, c);
+		return true;
+	});
 
-	if (Random(12) == 0) add();
+	for (uint8_t t = (n >> 7) + 1; t > 0; --t)
+		if (Random(12) == 0) add();
 }
 
 void worms::add(void) {
-	if (active >= 5) return;
+	if (pt.full()) return;
 
 	uint8_t mode = Random(3);
 	int n = strip.numPixels();
+	int pos;
 	switch (mode) {
     	case 0:														// Run from the start
-    		w[active].pos = 0;
+    		pos = 0;
     		break;
     	case 1:														// Run from the end
-    		w[active].pos = n-1;
+    		pos = n-1;
     		break;
     	case 2:														// Run from the aRandom position
     	default:
-    		w[active].pos = Random(n);
+    		pos = Random(n);
     		break;
 	}
-	w[active].color = strip.wheel(Random(256));
-	if (strip.getPixelColor(w[active].pos) != 0) return;
-	if (w[active].pos < n/3) {
-		w[active].fwd = true;
-	} else if ((n - w[active].pos) < n/3) {
-		w[active].fwd = false;
+	COLOR color = wheel(Random(256));
+	if (strip.getPixelColor(pos) != 0) return;
+	bool fwd;
+	if (pos < n/3) {
+		fwd = true;
+	} else if ((n - pos) < n/3) {
+		fwd = false;
 	} else {
-		w[active].fwd = Random(2);
+		fwd = Random(2);
 	}
-	++active;
-}
-
-void worms::die(uint8_t index) {
-	--active;
-	w[index].color = w[active].color;
-	w[index].pos   = w[active].pos;
-	w[index].fwd   = w[active].fwd;
+	pt.spawn(pos, color, fwd?1:-1);
 }
 
 //---------------------------------------------- Show interferention from many sources ----------------------------------
 void interfer::init(void) {
 	active	= 0;
 	tm		= 0;
+	limit	= 3 + (strip.numPixels() >> 7);						// More sources on the long strip
+	if (limit > num_inter) limit = num_inter;
 	add();
 }
 
+/*
+ * Every source emits the wave of its color. The phase of the wave is the time since the wave has been started
+ * minus the distance to the source, the wave period is 64. The component of the source color decreases by the
+ * triangle function of the phase: (31 - phase) * 8 in the first half of the period and (phase - 32) * 8 in the second one.
+ * The waves of all the sources are added modulo 256 (the component overflow is lost).
+ * Along the strip the phase of the source grows by one till the source position and decreases by one after it,
+ * so the phase is updated incrementally instead of the distance calculation for every pixel
+ */
 void interfer::show(void) {
 	int n = strip.numPixels();
 
+	for (uint8_t j = 0; j < active; ++j) {
+		int16_t radius	= tm - start[j];
+		int16_t reach	= (radius < n)?radius:n;
+		color[j]		= wheel(w[j]);
+		first[j]		= pos[j] - reach;
+		last[j]			= pos[j] + reach;
+		phase[j]		= radius - pos[j];								// The phase in the first pixel
+	}
+
 	for (int i = 0; i < n; ++i) {
 		COLOR c = 0;
 		for (uint8_t j = 0; j < active; ++j) {
-			COLOR c1 = clr(i, j);
-			c = TWOCLR::add(c, c1);
+			if (i >= first[j] && i <= last[j]) {						// The wave is here already
+				uint8_t e	= phase[j] & 63;
+				uint8_t elm	= (e < 32)?(31 - e) << 3:(e - 32) << 3;
+				c = clrAddWrap(c, clrSub(color[j], elm * 0x010101));
+			}
+			if (i < pos[j]) ++phase[j]; else --phase[j];
 		}
-		strip.setPixelColor(i, c);
+		strip.setPixelColor(i, c & 0xFFFFFF);
 	}
 	++tm;
 	if (tm %64 == 0) {
@@ -1023,38 +1172,13 @@ void interfer::show(void) {
 }
 
 void interfer::add(void) {
-	if (active >= num_inter) return;
+	if (active >= limit) return;
 	pos[active]		= Random(strip.numPixels());
 	w[active]		= Random(256);
 	start[active]	= tm;
 	active++;
 }
 
-uint32_t interfer::clr(int p, uint8_t source) {
-	uint32_t c = 0;
-	int s_pos = pos[source];
-	int e  = tm - start[source];
-	e -= abs(p - s_pos);
-	if (e < 0) return c;											// The wave is not here yet
-	e %= 64;														// The wave period
-	uint8_t elm = 0;
-	if (e < 32)														// Half way
-		elm = (31 - e) << 3;
-	else
-		elm = (e - 64) << 3;
-
-	uint32_t color = strip.wheel(w[source]);
-	for (uint8_t i = 0; i < 3; ++i) {
-		int max_c = (color >> (8*i)) & 0xff;
-		max_c -= elm;
-		if (max_c < 0) max_c = 0;
-			uint32_t nc = max_c;
-			nc <<= 8*i;
-			c |= nc;
-	}
-	return c;
-}
-
 //------------------------------------------- Random  colors toward each other ------------------------------------------
 void toward::show(void) {
 	int n = strip.numPixels();
@@ -1071,8 +1195,8 @@ void toward::show(void) {
 		strip.setPixelColor(n-1, 0);
 		w += 4;
 	} else {
-		strip.setPixelColor(0,   strip.wheel(w+128));
-		strip.setPixelColor(n-1, strip.wheel(w));
+		strip.setPixelColor(0,   wheel(w+128));
+		strip.setPixelColor(n-1, wheel(w));
 	}
 }
 
@@ -1092,8 +1216,8 @@ void towardRain::show(void) {
 		strip.setPixelColor(0,   0);
 		strip.setPixelColor(n-1, 0);
 	} else {
-		strip.setPixelColor(0,   strip.wheel(w)); w += 9;
-		strip.setPixelColor(n-1, strip.wheel(w)); w += 3;
+		strip.setPixelColor(0,   wheel(w)); w += 9;
+		strip.setPixelColor(n-1, wheel(w)); w += 3;
 	}
 }
 
@@ -1150,16 +1274,18 @@ void lghtHouse::show() {
 }
 
 //---------------------------------------------- Random dropped color dot fading out from epicenter ----------------------
+void rndDrops::init(void) {
+	uint16_t n = strip.numPixels() / 6;
+	pt.init((n > 16)?n:16);
+	add();
+}
+
 void rndDrops::show(void) {
 	int n = strip.numPixels();
-	for (uint8_t i = 0; i < num; ++i) {
-		if (++dr[i].tm > 7) {											// Delete old drops
-			dr[i].pos = dr[uint8_t(num-1)].pos;
-			dr[i].tm  = dr[uint8_t(num-1)].tm;
-			--num; --i;
-			continue;
-		}
-		int p = dr[i].pos - dr[i].tm;
+	pt.update([this, n](uint16_t i) {
+		uint8_t tm = ++pt.age[i];
+		if (tm > 7) return false;										// Delete old drops
+		int p = pt.pos[i] - tm;
 		if (p < 0) p += n;
 		COLOR c1 = strip.getPixelColor(p+1);
 		change(p+1, -64);
@@ -1167,31 +1293,31 @@ void rndDrops::show(void) {
 		c2 = TWOCLR::add(c1, c2);
 		strip.setPixelColor(p, c2);
 
-		p = dr[i].pos + dr[i].tm;
+		p = pt.pos[i] + tm;
 		if (p >= n) p -= n;
 		c1 = strip.getPixelColor(p-1);
-		if (dr[i].tm > 1) change(p-1, -32);
+		if (tm > 1) change(p-1, -32);
 		c2 = strip.getPixelColor(p);
 		c2 = TWOCLR::add(c1, c2);
 		strip.setPixelColor(p, c2);
 
-		change(dr[i].pos, -64);
-	}
+		change(pt.pos[i], -64);
+		return true;
+	});
 
 	changeAll(-32);
-	add();
+	for (uint8_t t = (n >> 7) + 1; t > 0; --t)
+		add();
 }
 
 void rndDrops::add(void) {
-	if (num >= 16) return;
+	if (pt.full()) return;
 	int pos	= Random(strip.numPixels());
 	COLOR c = strip.getPixelColor(pos);
 	if (c) return;
-	c = strip.wheel(Random(256));
+	c = wheel(Random(256));
 	strip.setPixelColor(pos, c);
-	dr[uint8_t(num)].pos = pos;
-	dr[uint8_t(num)].tm  = 0;
-	num++;
+	pt.spawn(pos, c);
 }
 
 // --------------------------------------------- Solitons are creaping up or down -----------------------------------------
@@ -1228,7 +1354,7 @@ void solCreep::show(void) {
 
 void solCreep::newSoliton(void) {
 	sol = -3;
-	COLOR c = strip.wheel(w);
+	COLOR c = wheel(w);
 	dot[0] = c;
 	w += 71;
 	uint32_t r = c & 0xff;
@@ -1264,7 +1390,7 @@ void theatChase::show(void) {
 		strip.setPixelColor(i + stp, 0);								// turn off previous state pixels
 
 	if (++stp >= 3) stp = 0;
-	COLOR color = strip.wheel(w);
+	COLOR color = wheel(w);
 	for (int i = 0; i < n; i += 3)
 		strip.setPixelColor(i + stp, color);
 	if (--color_shift <= 0) {
@@ -1411,6 +1537,11 @@ void symmRun::show(void) {
 void metSingle::init(void) {
 	uint16_t n	= strip.numPixels();
 	head		= Random(n - (n >> 2), n);								// Select starting position of the meteor head
+	head_fp		= uint32_t(head) << 8;
+	for (uint8_t i = 0; i < clr_size; ++i) {							// The meteor colors are the key colors of the gradient
+		uint8_t index = (uint16_t(i) * 255) / (clr_size - 1);
+		clr[i] = pal?pal->colorFromPalette(index):colorFromGradient(grad_meteor, index);
+	}
 	complete	= false;
 	do_clear	= false;
 }
@@ -1420,6 +1551,10 @@ void metSingle::show(void) {
 		if (Random(20) == 0) init();
 		return;
 	}
+	if (smooth) {
+		showSmooth();
+		return;
+	}
 
 	uint16_t n	= strip.numPixels();
 	if (head+clr_size+1 < n)
@@ -1437,6 +1572,22 @@ void metSingle::show(void) {
 	}
 }
 
+// The meteor moves by half of the pixel per step, the colors are split between the neighbor pixels
+void metSingle::showSmooth(void) {
+	uint16_t n	= strip.numPixels();
+	uint16_t h	= head_fp >> 8;
+	for (uint16_t i = h; i <= h + clr_size && i < n; ++i)				// Clear the meteor before drawing it in the new position
+		strip.setPixelColor(i, 0);
+	for (uint8_t i = 0; i < clr_size; ++i)
+		dot(head_fp + (uint32_t(i) << 8), clr[i]);
+	if (head_fp >= 128) {
+		head_fp -= 128;
+	} else {
+		strip.clear();
+		complete = true;
+	}
+}
+
 // --------------------------------------------- Classical multicolor strip simulation ------------------------------------
 void pureStrip::init(void) {
 	mode		= Random(4);
@@ -1448,9 +1599,13 @@ void pureStrip::init(void) {
 
 	num_color	= Random(3, 7);											// 3-6 different colors in the strip
 	if (Random(5) == 0) {												// Monochrome strip
-		COLOR c = strip.wheel(Random(256));
+		COLOR c = wheel(Random(256));
 		for (uint8_t i = 0; i < 6; ++i)
 			clr[i] = c;
+	} else if (pal) {													// The colors evenly spread over the palette
+		uint8_t index = Random(256);
+		for (uint8_t i = 0; i < num_color; ++i)
+			clr[i] = pal->colorFromPalette(index + (uint16_t(i) * 256) / num_color);
 	} else {															// Multicolor strip
 		uint8_t	available[6];											// Generate available color codes. This make sure each color used just obce
 		for (uint8_t i = 0; i < 6; ++i)
@@ -1553,7 +1708,7 @@ void sideFill::show(void) {
 		led_index = n - index -1;										// If we fill the strip from the back, fix the led position
 
 	if (on) {															// switch on new pixel
-		COLOR c = strip.wheel(w);
+		COLOR c = wheel(w);
 		if (rainbow) ++w;
 		strip.setPixelColor(led_index, c);
 		if (++index >= stage) {											// The stage is finished
@@ -1581,6 +1736,7 @@ void sideFill::show(void) {
 void browMotion::init(void) {
 	uint16_t n	= strip.numPixels();
 	pos			= Random(n+1);
+	pos_fp		= uint32_t(pos) << 8;
 	newDestination(n);
 	complete	= true;
 	do_clear	= true;
@@ -1588,10 +1744,23 @@ void browMotion::init(void) {
 
 void browMotion::show(void) {
 	changeAll(-12);
-	COLOR		c = strip.wheel(w);
+	COLOR		c = wheel(w);
 	uint16_t	n = strip.numPixels();
+	// Ease in and out: the dot accelerates after the start and slows down near the destination
+	uint16_t	path	 = abs(int16_t(destination) - int16_t(start));
+	uint16_t	passed	 = abs(int16_t(pos) - int16_t(start));
+	uint8_t		progress = 255;
+	if (path > 0 && passed < path) progress = (uint32_t(passed) << 8) / path;
+	uint8_t		bell	 = sin8(progress >> 1) << 1;					// sin(PI*progress/256): 0 at both ends, 254 in the middle
+	if (smooth) {
+		moveSmooth(c, bell, n);
+		return;
+	}
+	// Pixels to move in this step minus one: 0 near the ends of the path, abs(speed) in the middle, as the old constant speed
+	uint8_t		stp		 = (uint16_t(abs(speed) + 1) * bell + 127) / 254;
+	if (stp) --stp;
 	if (speed > 0) {													// Go forward
-		for (uint8_t i = 0; i <= speed; ++i) {
+		for (uint8_t i = 0; i <= stp; ++i) {
 			strip.setPixelColor(pos, c);
 			if (pos == destination) {
 				newDestination(n);
@@ -1604,7 +1773,7 @@ void browMotion::show(void) {
 			}
 		}
 	} else {															// Go backward
-		for (uint8_t i = 0; i <= abs(speed); ++i) {
+		for (uint8_t i = 0; i <= stp; ++i) {
 			strip.setPixelColor(pos, c);
 			if (pos == destination) {
 				newDestination(n);
@@ -1619,8 +1788,30 @@ void browMotion::show(void) {
 	}
 }
 
+// Move the dot by the fraction of the pixel: from 1/4 pixel near the ends of the path to abs(speed) pixels in the middle
+void browMotion::moveSmooth(COLOR c, uint8_t bell, uint16_t num_pixels) {
+	uint32_t dest	= uint32_t(destination) << 8;
+	uint32_t from	= pos_fp;
+	uint32_t dist	= 64 + uint16_t(abs(speed)) * bell;
+	bool	 reached = false;
+	if (pos_fp < dest) {
+		pos_fp += dist;
+		if (pos_fp >= dest) reached = true;
+	} else {
+		pos_fp = (pos_fp > dest + dist)?(pos_fp - dist):dest;
+		if (pos_fp <= dest) reached = true;
+	}
+	if (reached) pos_fp = dest;
+	uint32_t low	= (from < pos_fp)?from:pos_fp;
+	uint32_t high	= (from < pos_fp)?pos_fp:from;
+	segment(low, high - low + 256, c);								// The dot and the path it crossed during the step
+	pos = pos_fp >> 8;
+	if (reached) newDestination(num_pixels);
+}
+
 void browMotion::newDestination(uint16_t num_pixels) {
 	w 			= Random(256);
+	start		= pos;
 	destination	= Random(num_pixels+1);
 	speed		= (int16_t(destination) - int16_t(pos)) * 10 / num_pixels;
 	speed		= constrain(speed, 1, 3);
@@ -1629,7 +1820,8 @@ void browMotion::newDestination(uint16_t num_pixels) {
 
 // --------------------------------------------- Rain drops running down -------------------------------------------------
 void rainDrops::init(void) {
-	active_drops	= 0;
+	uint16_t n		= strip.numPixels() / 10;
+	pt.init((n > 10)?n:10);
 	complete		= true;
 	do_clear		= true;
 	newDrop();
@@ -1637,155 +1829,156 @@ void rainDrops::init(void) {
 
 void rainDrops::show(void) {
 	changeAll(-24);
-	for (uint8_t d = 0; d < active_drops; ++d) {
-		for (uint8_t s = 0; s <= drop[d].speed; ++s) {
-			if (drop[d].head < s) {
-				drop[d].c	= 0;										// Mark the drop to be deleted
+	pt.update([this](uint16_t i) {
+		uint16_t head = pt.pos[i];
+		for (uint8_t s = 0; s <= pt.vel[i]; ++s) {
+			if (head < s) {
+				pt.color[i] = 0;										// Mark the drop to be deleted
 				break;
 			}
-			strip.setPixelColor(drop[d].head-s, drop[d].c);
+			strip.setPixelColor(head-s, pt.color[i]);
 		}
-		if (drop[d].head >= drop[d].speed) {
-			drop[d].head -= drop[d].speed;
-		}
-		changeClr(drop[d].c, -16);
-	}
-
-	// Remove inactive drops
-	for (int8_t d = active_drops-1; d >= 0; --d) {
-		if (drop[d].c == 0) {
-			drop[d].c 		= drop[active_drops-1].c;
-			drop[d].speed	= drop[active_drops-1].speed;
-			drop[d].head	= drop[active_drops-1].head;
-			if (--active_drops == 0) break;
+		if (head >= pt.vel[i]) {
+			pt.pos[i] = head - pt.vel[i];
 		}
-	}
+		changeClr(pt.color[i], -16);
+		return pt.color[i] != 0;
+	});
 
 	// Create new Drops
-	if (active_drops < max_drops && Random(10) == 0) {
-		newDrop();
-	}
+	for (uint8_t t = (strip.numPixels() >> 7) + 1; t > 0; --t)
+		if (!pt.full() && Random(10) == 0) newDrop();
 }
 
 void rainDrops::newDrop(void) {
-	if (active_drops >= max_drops)
-		return;
-	uint16_t n	= strip.numPixels();
-	drop[active_drops].head		= Random(n >> 1, n+1);
-	drop[active_drops].c		= strip.wheel(Random(256));
-	drop[active_drops].speed	= Random(1, 4);
-	++active_drops;
+	uint16_t n		= strip.numPixels();
+	uint16_t head	= Random(n >> 1, n+1);
+	COLOR c			= wheel(Random(256));
+	pt.spawn(head, c, Random(1, 4));
 }
 
 // --------------------------------------------- Ripe fruits booms and run two pieces ------------------------------------
 void ripeFruit::init(void) {
-	active_fruits	= 0;
+	uint16_t n		= strip.numPixels() / 10;
+	pt.init((n > 10)?n:10);
 	complete		= true;
 	do_clear		= true;
 	newFruit();
 }
 
+/*
+ * The particle position is the first part of the fruit, the second part is in aux.
+ * The velocity is zero while the fruit is getting ready
+ */
 void ripeFruit::show(void) {
 	uint16_t n	= strip.numPixels();
-	for (uint16_t i = 0; i < n; ++i) {									// Fade out all pixels except the active one
-		bool skip = false;
-		for (uint8_t f = 0; f < active_fruits; ++f) {
-			if ((fruit[f].speed == 0) && (i == fruit[f].part[0])) {
-				skip = true;
-				break;
-			}
-		}
-		if (!skip) change(i, -16);
-	}
-
-	for (uint8_t f = 0; f < active_fruits; ++f) {
-		if (fruit[f].speed == 0) {										// The fruit is getting ready
-			setColor(fruit[f].c);
-			if (change(fruit[f].part[0], 2)) {							// The fruit is ripen
-				strip.setPixelColor(fruit[f].part[0], 0xffffff);
-				fruit[f].part[1] = fruit[f].part[0] + 1;
-				fruit[f].speed	= Random(1, 3);							// Start moving
+	for (uint16_t i = 0; i < n; ++i) {									// Fade out all pixels except the fruits
+		if (!pt.occupied(i)) change(i, -16);
+	}
+
+	pt.update([this, n](uint16_t f) {
+		uint8_t speed = pt.vel[f];
+		if (speed == 0) {												// The fruit is getting ready
+			setColor(pt.color[f]);
+			if (change(pt.pos[f], 2)) {									// The fruit is ripen
+				strip.setPixelColor(pt.pos[f], 0xffffff);
+				pt.aux[f] = pt.pos[f] + 1;
+				pt.vel[f] = Random(1, 3);								// Start moving
 			}
 		} else {														// The fruit parts are moving
-			for (uint8_t s = 0; s <= fruit[f].speed; ++s) {
-				if (fruit[f].part[0] >= s) {
-					strip.setPixelColor(fruit[f].part[0]-s, fruit[f].c);
+			for (uint8_t s = 0; s <= speed; ++s) {
+				if (pt.pos[f] >= s) {
+					strip.setPixelColor(pt.pos[f]-s, pt.color[f]);
 				}
-				if (fruit[f].part[1] + s < n) {
-					strip.setPixelColor(fruit[f].part[1]+s, fruit[f].c);
+				if (pt.aux[f] + s < n) {
+					strip.setPixelColor(pt.aux[f]+s, pt.color[f]);
 				}
 			}
 
-			if (fruit[f].part[0] >= fruit[f].speed) {
-				fruit[f].part[0] -= fruit[f].speed;
+			if (pt.pos[f] >= speed) {
+				pt.pos[f] -= speed;
 			} else {
-				fruit[f].c	= 0;										// Mark to be deleted
+				pt.color[f]	= 0;										// Mark to be deleted
 			}
-			if (fruit[f].part[1] +  fruit[f].speed < n) {
-				fruit[f].part[1] += fruit[f].speed;
+			if (pt.aux[f] + speed < n) {
+				pt.aux[f] += speed;
 			} else {
-				fruit[f].c	= 0;										// Mark to be deleted
+				pt.color[f]	= 0;										// Mark to be deleted
 			}
 
 		}
-		changeClr(fruit[f].c, -16);
-	}
-	// Remove inactive fruits
-	for (int8_t f = active_fruits-1; f >= 0; --f) {
-		if (fruit[f].c == 0) {
-			fruit[f].c 			= fruit[active_fruits-1].c;
-			fruit[f].speed		= fruit[active_fruits-1].speed;
-			fruit[f].part[0]	= fruit[active_fruits-1].part[0];
-			fruit[f].part[1]	= fruit[active_fruits-1].part[1];
-			if (--active_fruits == 0) break;
-		}
-	}
+		changeClr(pt.color[f], -16);
+		return pt.color[f] != 0;
+	});
 
 	// Create new Fruit
-	if (active_fruits < max_fruits && Random(5) == 0) {
-		newFruit();
-	}
+	for (uint8_t t = (n >> 7) + 1; t > 0; --t)
+		if (!pt.full() && Random(5) == 0) newFruit();
 }
 
 void ripeFruit::newFruit(void) {
-	if (active_fruits >= max_fruits)
-		return;
-	uint16_t n	= strip.numPixels();
-	fruit[active_fruits].part[0]= Random(4, n - 5);
-	fruit[active_fruits].part[1]= n;									// Not active yet
-	fruit[active_fruits].c		= strip.wheel(Random(256));
-	fruit[active_fruits].speed	= 0;
-	++active_fruits;
+	uint16_t n		= strip.numPixels();
+	uint16_t part	= Random(4, n - 5);
+	pt.spawn(part, wheel(Random(256)), 0, n);						// The second part is not active yet
 }
 
 // --------------------------------------------- The single color that changes the brightness as a sine ------------------
 void brightWave::init(void) {
+	uint16_t n	= strip.numPixels();
 	w			= Random(256);
 	t			= 0;
+	wave_step	= 65536 / Random(64, (n >> 1) + 65);					// The wave length is 64 pixels or longer on the long strip
+	step_part	= 0;
 	fwd			= Random(2);
 	complete	= true;
 	do_clear	= true;
 }
 
 void brightWave::show(void) {
-	COLOR color = strip.wheel(w);
+	draw();
+	move(256);
+}
+
+// The wave moves smoothly with the constant speed: one wave_step per period, the frame rate does not matter
+bool brightWave::advance(uint32_t ms, uint16_t period) {
+	uint32_t s = timeSteps(ms, period);
+	if (s == 0) return false;
+	if (s > 256 * max_catch_up) s = 256 * max_catch_up;
+	move(s);
+	draw();
+	return true;
+}
+
+void brightWave::draw(void) {
+	COLOR color = wheel(w);
+	uint16_t phase = t >> 8;
 	for (uint16_t i = 0; i < strip.numPixels(); ++i) {
-		COLOR c = intencity(color, i+t);
+		COLOR c = intencity16(color, phase);
 		strip.setPixelColor(i, c);
+		phase += wave_step;
 	}
-	if (fwd) --t; else ++t;
-	if (Random(10) == 0) {
-		++w;
-		if (Random(30) == 0)
-			fwd = !fwd;
+}
+
+// Move the wave by the number of steps in 1/256 units, change the color every 10 steps in average
+void brightWave::move(uint32_t steps) {
+	if (fwd) t -= steps * wave_step; else t += steps * wave_step;
+	step_part += steps;
+	for ( ; step_part >= 256; step_part -= 256) {
+		if (Random(10) == 0) {
+			++w;
+			if (Random(30) == 0)
+				fwd = !fwd;
+		}
 	}
 }
 
 // --------------------------------------------- Color pixels walking up and down with sine brightness -------------------
 void brColCreep::init(void) {
+	uint16_t n	= strip.numPixels();
 	fwd			= Random(2);
 	w			= Random(256);
-	t			= Random(64);
+	t			= Random(65536);
+	wave_step	= 65536 / Random(64, (n >> 2) + 65);					// The wave length is 64 pixels or longer on the long strip
 	complete	= true;
 	do_clear	= true;
 }
@@ -1794,90 +1987,107 @@ void brColCreep::show(void) {
 	step();
 	uint16_t	pos	= strip.numPixels() - 1;
 	if (fwd)	pos	= 0;
-	COLOR		c	= strip.wheel(++w);
-	c				= intencity(c, t);
-	if (++t >= 64)	t = 0;
+	COLOR		c	= wheel(++w);
+	c				= intencity16(c, t);
+	t			   += wave_step;
 	strip.setPixelColor(pos, c);
 }
 
 // --------------------------------------------- Color drops increasing brightness and then generates the fading wave ----
 void dropFade::init(void) {
-	active_drops	= 0;
+	uint16_t n		= strip.numPixels() / 7;
+	pt.init((n > 15)?n:15);
 	complete		= true;
 	do_clear		= true;
 	newDrop();
 }
 
+/*
+ * The particle aux keeps the wheel index of the drop color, the particle color keeps the rising drop color,
+ * so the drop is restored after the blur
+ */
 void dropFade::show(void) {
-	// First, proceed the drops
-	for (uint8_t i = 0; i < active_drops; ++i) {
-		COLOR c = strip.wheel(drop[i].w);
-		setColor(c);
-		if (change(drop[i].pos, 4)) {										// Increase the color brightness of the drop
-			drop[i].remove	= true;											// Mark to be deleted
-		}
-	}
+	// First, spread the light of the bright drops to the neighbors and fade it out
+	blur1d(96);
+	changeAll(-8);
 
+	// Second, proceed the drops, release the bright ones
+	pt.update([this](uint16_t i) {
+		strip.setPixelColor(pt.pos[i], pt.color[i]);
+		setColor(wheel(pt.aux[i]));
+		bool rising		= !change(pt.pos[i], 4);						// Increase the color brightness of the drop
+		pt.color[i]		= strip.getPixelColor(pt.pos[i]);
+		return rising;
+	});
 
-	// Remove inactive drops
-	for (int8_t d = active_drops-1; d >= 0; --d) {
-		if (drop[d].remove) {
-			drop[d].w 		= drop[active_drops-1].w;
-			drop[d].pos		= drop[active_drops-1].pos;
-			drop[d].remove	= drop[active_drops-1].remove;
-			if (--active_drops == 0) break;
-		}
-	}
-
-	// Second, calculate the Waves from the 'ready' drop
-	COLOR prev_c	= 0;
-	COLOR c 		= strip.getPixelColor(0);
-	COLOR next_c	= 0;
+	// Create new Drops
 	uint16_t n		= strip.numPixels();
-	for (uint16_t i = 0; i < n; ++i) {
-		if (i < n-1)
-			next_c	= strip.getPixelColor(i+1);
-		else
-			next_c	= 0;
-		if (!isActiveDrop(i) && c) {
-			changeClr(c, -8);
-			if (i > 0 && prev_c == 0) {
-				strip.setPixelColor(i-1, c);
-			}
-			if (i < n-1 && next_c == 0) {
-				strip.setPixelColor(i+1, c);
-			}
-			changeClr(c, -8);
-			strip.setPixelColor(i, c);
-		}
-		prev_c	= c;
-		c		= next_c;
+	for (uint8_t t = (n >> 7) + 1; t > 0; --t)
+		if (!pt.full() && Random(10) == 0) newDrop();
+}
+
+void dropFade::newDrop(void) {
+	uint16_t n			= strip.numPixels();
+	uint16_t new_pos	= Random(n);										// The drop outside the strip never gets bright
+	if (!pt.occupied(new_pos)) {
+		pt.spawn(new_pos, 0, 0, Random(256));
 	}
+}
 
-	// Create new Drops
-	if (active_drops < max_drops && Random(10) == 0) {
-		newDrop();
+// --------------------------------------------- The lava lamp: slow blobs of the noise colored by the palette -----------
+void lavaLamp::init(void) {
+	t		= Random(65536);
+	scale	= Random(12, 40);
+	speed	= Random(3, 10);
+}
+
+void lavaLamp::show(void) {
+	uint16_t x = 0;
+	for (uint16_t i = 0; i < strip.numPixels(); ++i) {
+		uint8_t v = fractal8(x, t, 2);
+		strip.setPixelColor(i, pal?pal->colorFromPalette(v):colorFromPalette(pal16_lava, v));
+		x += scale;
 	}
+	t += speed;
 }
 
-void dropFade::newDrop(void) {
-	if (active_drops >= max_drops)
-		return;
-	uint16_t n			= strip.numPixels();
-	uint16_t new_pos	= Random(n+1);
-	if (!isActiveDrop(new_pos)) {
-		drop[active_drops].pos		= new_pos;
-		drop[active_drops].w		= Random(256);
-		drop[active_drops].remove	= false;
-		++active_drops;
+// --------------------------------------------- The aurora: green to violet curtains waving slowly ----------------------
+void aurora::init(void) {
+	t		= Random(65536);
+	scale	= Random(16, 48);
+	speed	= Random(4, 12);
+}
+
+// The hue drifts from green to violet, the brightness is the noise of the higher frequency with the dark gaps
+void aurora::show(void) {
+	uint16_t x = 0;
+	for (uint16_t i = 0; i < strip.numPixels(); ++i) {
+		uint8_t hue	= 96 + scale8(noise8(x >> 1, t >> 1), 104);
+		uint8_t v	= fractal8(x + 0x8000, t, 2);
+		v			= (v > 96)?v - 96:0;						// The curtains are separated by the dark sky
+		uint16_t b	= uint16_t(v) * 8 / 5;
+		strip.setPixelColor(i, strip.ColorHSV(hue, 240, (b > 255)?255:b));
+		x += scale;
 	}
+	t += speed;
 }
 
-bool dropFade::isActiveDrop(uint16_t pos) {
-	for (uint8_t i = 0; i < active_drops; ++i) {
-		if (pos == drop[i].pos) {											// Found active drop in this position
-			return true;
-		}
+// --------------------------------------------- The candles: each pixel is a flickering flame ---------------------------
+void candles::init(void) {
+	t		= Random(65536);
+	hue		= Random(12, 32);
+	speed	= Random(24, 48);
+}
+
+// Every pixel reads the one-dimensional noise at its own far position, so the flames flicker independently
+void candles::show(void) {
+	uint16_t x = t;
+	for (uint16_t i = 0; i < strip.numPixels(); ++i) {
+		uint8_t f = noise8(x);										// The flame flicker
+		uint8_t s = noise8((x >> 2) + 0x8000);						// The slow flame size
+		uint8_t v = 64 + scale8(s, 96) + scale8(f, 95);
+		strip.setPixelColor(i, strip.ColorHSV(hue + (f >> 5), 255 - (f >> 2), v));
+		x += 0x2D00;												// 45 cells apart
 	}
-	return false;
+	t += speed;
 }
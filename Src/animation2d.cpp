@@ -0,0 +1,122 @@
+#include "animation2d.h"
+
+// --------------------------------------------- Rain drops falling down the panel columns --------------------------------
+void mxRainDrops::init(void) {
+	active_drops	= 0;
+	complete		= true;
+	do_clear		= true;
+	newDrop();
+}
+
+void mxRainDrops::show(void) {
+	changeAll(-24);
+	for (uint8_t d = 0; d < active_drops; ++d) {
+		for (uint8_t s = 0; s <= drop[d].speed; ++s)
+			matrix.setPixel(drop[d].x, drop[d].y + s, drop[d].c);	// The drop tail is clipped by the panel border
+		drop[d].y += drop[d].speed;
+		if (drop[d].y >= matrix.height())
+			drop[d].c = 0;											// Mark the drop to be deleted
+		else
+			changeClr(drop[d].c, -8);
+	}
+
+	// Remove inactive drops
+	for (int8_t d = active_drops-1; d >= 0; --d) {
+		if (drop[d].c == 0) {
+			drop[d] = drop[active_drops-1];
+			if (--active_drops == 0) break;
+		}
+	}
+
+	// Create new Drops
+	if (active_drops < max_drops && Random(4) == 0) {
+		newDrop();
+	}
+}
+
+void mxRainDrops::newDrop(void) {
+	if (active_drops >= max_drops || matrix.width() == 0)
+		return;
+	drop[active_drops].x		= Random(matrix.width());
+	drop[active_drops].y		= -int16_t(Random((matrix.height() >> 1) + 1));
+	drop[active_drops].c		= wheel(Random(256));
+	drop[active_drops].speed	= Random(1, 3);
+	++active_drops;
+}
+
+// --------------------------------------------- The rainbow running along the panel diagonal ----------------------------
+void mxRainbow::init(void) {
+	index	= Random(256);
+	uint16_t span = matrix.width() + matrix.height();			// The whole color wheel fits the diagonal
+	dx		= 256 / (span + 1);
+	dy		= dx;
+	if (Random(2)) dy = -dy;										// The rainbow goes to the other diagonal
+	complete	= true;
+	do_clear	= true;
+}
+
+void mxRainbow::show(void) {
+	uint8_t row = index;
+	for (uint8_t y = 0; y < matrix.height(); ++y) {
+		uint8_t w = row;
+		for (uint8_t x = 0; x < matrix.width(); ++x) {
+			matrix.setPixel(x, y, wheel(w));
+			w += dx;
+		}
+		row += dy;
+	}
+	++index;
+}
+
+// --------------------------------------------- The line bouncing from the panel borders leaving the fading trace --------
+void mxLines::init(void) {
+	for (uint8_t i = 0; i < 2; ++i) {
+		x[i]	= Random(matrix.width());
+		y[i]	= Random(matrix.height());
+		vx[i]	= Random(1, 3); if (Random(2)) vx[i] = -vx[i];
+		vy[i]	= Random(1, 3); if (Random(2)) vy[i] = -vy[i];
+	}
+	w			= Random(256);
+	complete	= true;
+	do_clear	= true;
+}
+
+void mxLines::show(void) {
+	changeAll(-32);
+	matrix.line(x[0], y[0], x[1], y[1], wheel(w));
+	for (uint8_t i = 0; i < 2; ++i) {
+		move(x[i], vx[i], matrix.width());
+		move(y[i], vy[i], matrix.height());
+	}
+	w += 3;
+}
+
+// Move the coordinate by the velocity, reflect it from the borders
+void mxLines::move(int16_t& p, int8_t& v, uint8_t size) {
+	p += v;
+	if (p < 0) {
+		p = -p;
+		v = -v;
+	} else if (p >= size) {
+		p = 2 * (size - 1) - p;
+		v = -v;
+	}
+	p = constrain(p, 0, size - 1);
+}
+
+// --------------------------------------------- Color boxes appearing at random places and fading out -------------------
+void mxBoxes::init(void) {
+	complete	= true;
+	do_clear	= true;
+}
+
+void mxBoxes::show(void) {
+	changeAll(-16);
+	if (Random(3) == 0) {
+		uint8_t bw = Random(1, (matrix.width()  >> 1) + 2);
+		uint8_t bh = Random(1, (matrix.height() >> 1) + 2);
+		int16_t bx = int16_t(Random(matrix.width()  + bw)) - bw;	// The box can cross the panel border
+		int16_t by = int16_t(Random(matrix.height() + bh)) - bh;
+		matrix.fillRect(bx, by, bw, bh, wheel(Random(256)));
+	}
+}
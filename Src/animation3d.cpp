@@ -0,0 +1,98 @@
+#include "animation3d.h"
+
+// --------------------------------------------- The horizontal plane moving up and down the tree ------------------------
+void treeSweep::init(void) {
+	level		= 0;
+	speed		= Random(2, 6);
+	width		= Random(16, 48);
+	w			= Random(256);
+	complete	= true;
+	do_clear	= true;
+}
+
+void treeSweep::show(void) {
+	COLOR	 color	= wheel(w);
+	uint16_t fall	= TREE3D::falloff(width);
+	uint16_t num	= tree.numPixels();
+	for (uint16_t n = 0; n < num; ++n)
+		strip.setPixelColor(n, nscale8(color, tree.plane(n, level, fall)));
+
+	int16_t l = int16_t(level) + speed;
+	if (l < 0 || l > 255) {											// The plane reached the top or the bottom, change the direction and color
+		speed = -speed;
+		l = constrain(l, 0, 255);
+		w += 71;
+	}
+	level = l;
+}
+
+// --------------------------------------------- Two light beams rotating around the trunk -------------------------------
+void treeBeam::init(void) {
+	direction	= Random(256);
+	speed		= Random(2, 6);
+	if (Random(2)) speed = -speed;
+	width		= Random(16, 40);
+	w			= Random(256);
+	complete	= true;
+	do_clear	= true;
+}
+
+void treeBeam::show(void) {
+	COLOR	 c1		= wheel(w);
+	COLOR	 c2		= wheel(w + 128);
+	uint16_t fall	= TREE3D::falloff(width);
+	uint16_t num	= tree.numPixels();
+	for (uint16_t n = 0; n < num; ++n) {
+		COLOR c = nscale8(c1, tree.beam(n, direction, fall));
+		c = clrMax(c, nscale8(c2, tree.beam(n, direction + 128, fall)));	// The second beam is opposite to the first one
+		strip.setPixelColor(n, c);
+	}
+	direction += speed;
+	++w;
+}
+
+// --------------------------------------------- The spheres growing from the random points inside the tree --------------
+void treePulse::init(void) {
+	newPulse();
+	complete	= true;
+	do_clear	= true;
+}
+
+void treePulse::show(void) {
+	changeAll(-32);
+	uint16_t fall = TREE3D::falloff(24);
+	uint16_t num	= tree.numPixels();
+	for (uint16_t n = 0; n < num; ++n) {
+		uint8_t i = tree.sphere(n, cx, cy, ch, radius, fall);
+		if (i) strip.setPixelColor(n, clrMax(strip.getPixelColor(n), nscale8(c, i)));
+	}
+	radius += 6;
+	if (radius > 300) newPulse();									// The sphere is bigger than the tree
+}
+
+void treePulse::newPulse(void) {
+	cx		= int8_t(Random(128)) - 64;
+	cy		= int8_t(Random(128)) - 64;
+	ch		= Random(256);
+	radius	= 0;
+	c		= wheel(Random(256));
+}
+
+// --------------------------------------------- The flames rise from the bottom of the tree around the trunk -----------
+void treeFire::init(void) {
+	fire.init(Random(3, 7), levels);
+	fire.setCooling(Random(50, 90));
+	fire.setSparking(Random(90, 180));
+}
+
+// The LED gets the heat of the flame by its angle and the cell by its height
+void treeFire::show(void) {
+	fire.step();
+	uint8_t  flames	= fire.flames();
+	uint16_t num	= tree.numPixels();
+	for (uint16_t n = 0; n < num; ++n) {
+		uint8_t f = (uint16_t(tree.angle(n)) * flames) >> 8;
+		uint8_t c = (uint16_t(tree.height(n)) * levels) >> 8;
+		strip.setPixelColor(n, fire.color(f, c));
+	}
+}
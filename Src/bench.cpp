@@ -0,0 +1,290 @@
+#include "bench.h"
+#include "blur.h"
+#include "compositor.h"
+#include "interpolator.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+//---------------------------------------------- The target platform: DWT cycle counter and SWO output -----------------
+#if defined(DWT) && defined(ITM)
+void benchClockStart(void) {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT		  = 0;
+	DWT->CTRL		 |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t benchCycles(void) {
+	return DWT->CYCCNT;
+}
+
+uint32_t benchCyclesPerUs(void) {
+	return SystemCoreClock / 1000000;
+}
+
+void benchPrint(const char *line) {
+	while (*line)
+		ITM_SendChar(*line++);
+	ITM_SendChar('\n');
+}
+#endif
+
+//---------------------------------------------- The still picture of the compositor layer -----------------------------
+class benchLayer : public animation {
+	public:
+		benchLayer(void)											{ min_p = 1; max_p = 1; show_time = 1; }
+		virtual void	init(void);
+		virtual void	show(void)									{ }
+};
+
+// The random colors, the compositor kernels measure the blending only
+void benchLayer::init(void) {
+	for (uint16_t i = 0; i < strip.numPixels(); ++i)
+		strip.setPixelColor(i, strip.wheel(Random(256)));
+}
+
+//---------------------------------------------- The interferention of all the sources --------------------------------
+class benchInterfer : public interfer {
+	public:
+		void	fill(void);
+};
+
+// All the sources the strip can have, their waves have reached the whole strip already
+void benchInterfer::fill(void) {
+	init();
+	while (active < limit) add();
+	for (uint8_t j = 0; j < active; ++j)
+		start[j] = tm - strip.numPixels();
+}
+
+//---------------------------------------------- The benchmark runner ---------------------------------------------------
+static volatile uint32_t sink;										// Keeps the results of the read-only kernels
+static benchLayer	layer_base, layer_top;
+static COMPOSITOR	cmp;											// The layer buffers are reused by the next strip length
+static INTERPOLATOR	ip;												// The keyframe buffers are reused by the next strip length
+
+static int cmpCycles(const void *a, const void *b) {
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+bool BENCH::init(uint16_t n) {
+	free(samples);
+	samples	= (uint32_t *)malloc(n * sizeof(uint32_t));
+	frames	= samples?n:0;
+	return samples != 0;
+}
+
+void BENCH::header(void) {
+	benchPrint("name,leds,frames,period_us,min_us,median_us,p99_us,max_us,reads,writes");
+}
+
+/*
+ * The animation makes one step per advance() call: the time moves by the step period exactly.
+ * The step period is the shortest one the manager can choose, so the render time should fit it
+ */
+void BENCH::animations(animation* a[], uint8_t num) {
+	if (!frames) return;
+	char	 name[8];
+	uint32_t ms = 0;
+	for (uint8_t i = 0; i < num; ++i) {
+		animation *an = a[i];
+		an->setPalette(0);
+		strip.setIndexed(0);
+		strip.clear();
+		an->init();													// The initialization can change the period limits
+		an->do_clear	= false;
+		an->resetTime();
+		uint16_t period	= uint16_t(an->min_p) * 10 + 1;
+		reads = writes	= 0;
+		for (uint16_t f = 0; f < frames; ++f) {
+			if (an->do_clear) {										// The manager would clear the strip and start again
+				strip.setIndexed(0);
+				strip.clear();
+				an->init();
+				an->do_clear = false;
+				an->resetTime();
+			}
+			ms += period;
+			strip.resetAccess();
+			uint32_t start	= benchCycles();
+			an->advance(ms, period);
+			samples[f]		= benchCycles() - start;
+			uint32_t r, w;
+			strip.pixelAccess(r, w);
+			reads  += r;
+			writes += w;
+		}
+		snprintf(name, sizeof(name), "%u", i);
+		report(name, uint32_t(period) * 1000);
+	}
+	strip.setIndexed(0);
+	strip.clear();
+}
+
+// The drawing primitives on the whole strip: prep(frame) makes the strip ready, run(frame) is timed
+template <typename PREPARE, typename RUN>
+void BENCH::kernel(const char *name, PREPARE prep, RUN run) {
+	reads = writes = 0;
+	for (uint16_t f = 0; f < frames; ++f) {
+		prep(f);
+		strip.resetAccess();
+		uint32_t start	= benchCycles();
+		run(f);
+		samples[f]		= benchCycles() - start;
+		uint32_t r, w;
+		strip.pixelAccess(r, w);
+		reads  += r;
+		writes += w;
+	}
+	report(name, 0);
+}
+
+void BENCH::kernels(void) {
+	if (!frames) return;
+	uint16_t n		= strip.numPixels();
+	int16_t	 step	= (n > 2)?int16_t(0x10000UL / n):0x4000;		// One rainbow along the strip
+	BLUR	 blur;
+	SUBPIXEL sub;
+	BRGTN	 brgtn;
+	strip.setIndexed(0);
+	strip.clear();
+	auto none		= [](uint16_t) { };
+	auto sparse		= [n](uint16_t) {								// A quarter of the pixels is lit
+		for (uint16_t i = 0; i < n; ++i)
+			strip.setPixelColor(i, (Random(4) == 0)?strip.wheel(Random(256)):0);
+	};
+	kernel("setPixel",		none,	[n](uint16_t f) {
+		for (uint16_t i = 0; i < n; ++i) strip.setPixelColor(i, strip.wheel(i + f));
+	});
+	kernel("setPixel.rev",	none,	[n](uint16_t f) {				// The view overhead: the reversed view of the whole strip
+		PIXEL_SURFACE rev = { 0, n, VIEW_REVERSE };
+		strip.setView(&rev);
+		for (uint16_t i = 0; i < n; ++i) strip.setPixelColor(i, strip.wheel(i + f));
+		strip.setView(0);
+	});
+	kernel("setPixel.zones",none,	[n](uint16_t f) {				// Two zones as the manager runs them
+		uint16_t half = n >> 1;
+		PIXEL_SURFACE zone[2] = { { 0, half, 0 }, { half, uint16_t(n - half), VIEW_REVERSE } };
+		for (uint8_t z = 0; z < 2; ++z) {
+			strip.setView(&zone[z]);
+			uint16_t len = strip.numPixels();
+			for (uint16_t i = 0; i < len; ++i) strip.setPixelColor(i, strip.wheel(i + f));
+		}
+		strip.setView(0);
+	});
+	kernel("getPixel",		none,	[n](uint16_t) {
+		COLOR c = 0;
+		for (uint16_t i = 0; i < n; ++i) c |= strip.getPixelColor(i);
+		sink = c;
+	});
+	kernel("fillHSV",		none,	[n, step](uint16_t f) { strip.fillHSV(0, n, f << 8, step); });
+	auto blank		= [](uint16_t) { strip.clear(); };
+	kernel("subpixel.dot",	blank,	[n, &sub](uint16_t f) {			// One dot per pixel at the fractional position
+		for (uint16_t i = 0; i < n; ++i) sub.dot((uint32_t(i) << 8) + uint8_t(f * 37), strip.wheel(i + f));
+	});
+	kernel("subpixel.segment", blank, [n, &sub](uint16_t f) {		// The segments of 4.5 pixels, half a pixel apart
+		for (uint32_t pos = uint8_t(f * 37); pos < (uint32_t(n) << 8); pos += 5 << 8)
+			sub.segment(pos, 0x480, strip.wheel(pos >> 8));
+	});
+	kernel("litRebuild",	[&sparse](uint16_t f) { sparse(f); strip.bufferChanged(); },
+									[](uint16_t) { sink = strip.litPixels(); });
+	kernel("litPixel",		none,	[n](uint16_t f) { sink = strip.litPixel((f * 7) % (n / 4 + 1)); });
+	kernel("unlitPixel",	none,	[n](uint16_t f) { sink = strip.unlitPixel((f * 7) % (n / 2 + 1)); });
+	kernel("isDark",		none,	[](uint16_t) { sink = strip.isDark(); });
+	kernel("litPixels.view",none,	[n](uint16_t) {				// The unaligned reversed range as the second zone
+		PIXEL_SURFACE part = { uint16_t(n / 3), uint16_t(n - n / 3), VIEW_REVERSE };
+		strip.setView(&part);
+		sink = strip.litPixels();
+		strip.setView(0);
+	});
+	auto full		= [n](uint16_t f) {								// All the pixels are lit
+		for (uint16_t i = 0; i < n; ++i) strip.setPixelColor(i, strip.wheel(i + f));
+	};
+	// The baseline of the buffer fade: changeAll(-16) as it was, the color of every pixel is read, decremented and written
+	auto perPixel	= [n, &brgtn](uint16_t) {
+		for (uint16_t i = 0; i < n; ++i) {
+			COLOR c = strip.getPixelColor(i);
+			brgtn.changeClr(c, -16);
+			strip.setPixelColor(i, c);
+		}
+	};
+	kernel("fade.perPixel",	sparse,	perPixel);
+	kernel("fade",			sparse,	[&brgtn](uint16_t) { brgtn.changeAll(-16); });
+	kernel("fade.perPixel.full", full, perPixel);
+	kernel("fade.full",		full,	[&brgtn](uint16_t) { brgtn.changeAll(-16); });
+	kernel("scaleAll",		sparse,	[](uint16_t) { strip.scaleAll(224); });
+	kernel("subtractAll",	sparse,	[](uint16_t) { strip.subtractAll(16); });
+	kernel("fadeToBlackBy",	sparse,	[](uint16_t) { strip.fadeToBlackBy(32); });
+	kernel("blur.box1",		sparse,	[&blur](uint16_t) { blur.box(1); });
+	kernel("blur.box16",	sparse,	[&blur](uint16_t) { blur.box(16); });
+	kernel("blur.gauss4",	sparse,	[&blur](uint16_t) { blur.gauss(4); });
+	kernel("blur1d",		sparse,	[&blur](uint16_t) { blur.blur1d(64); });
+	// The base layer and the top one blended in the mode, as the manager runs the overlay and the crossfade
+	static const struct {
+		const char	*name;
+		LAYER_MODE	mode;
+		uint8_t		alpha;
+	} blends[] = {
+		{ "layer.add",		LAYER_ADD,		255 },
+		{ "layer.add128",	LAYER_ADD,		128 },
+		{ "layer.max",		LAYER_MAX,		255 },
+		{ "layer.alpha",	LAYER_ALPHA,	128 },
+		{ "layer.multiply",	LAYER_MULTIPLY,	255 }
+	};
+	for (uint8_t b = 0; b < sizeof(blends) / sizeof(blends[0]); ++b) {
+		cmp.clear();
+		if (!cmp.addLayer(&layer_base, LAYER_ADD) || !cmp.addLayer(&layer_top, blends[b].mode, blends[b].alpha)) {
+			benchPrint("# not enough memory for the layers");
+			break;
+		}
+		cmp.init();
+		kernel(blends[b].name,	none,	[](uint16_t) { cmp.compose(); });
+	}
+	cmp.clear();
+	// The slow animation of 100 ms step interpolated every 10 ms: the keyframe copy every 10th frame, the mix in every frame
+	if (ip.start()) {
+		char	 line[48];
+		uint32_t ms = 0;
+		snprintf(line, sizeof(line), "# interp buffers %u bytes", 2 * strip.bufferSize());
+		benchPrint(line);
+		layer_top.resetTime();
+		kernel("interp",	[&ms](uint16_t) { ms += 10; },	[&ms](uint16_t) { ip.show(&layer_top, ms, 100); });
+		ip.stop();
+	} else {
+		benchPrint("# not enough memory for the interpolator");
+	}
+	benchInterfer inter;
+	inter.fill();
+	kernel("interfer.full",	none,	[&inter](uint16_t) { inter.show(); });
+	kernel("noise8",		none,	[n](uint16_t f) {
+		uint8_t s = 0;
+		for (uint16_t i = 0; i < n; ++i) s += noise8(i << 5, f << 4);
+		sink = s;
+	});
+	kernel("fractal8x2",	none,	[n](uint16_t f) {
+		uint8_t s = 0;
+		for (uint16_t i = 0; i < n; ++i) s += fractal8(i << 5, f << 4, 2);
+		sink = s;
+	});
+	strip.clear();
+}
+
+// Print the microseconds of the cycle count with one decimal digit
+static void printUs(char *buff, uint8_t size, uint32_t cycles, uint32_t per_us) {
+	snprintf(buff, size, "%lu.%lu", (unsigned long)(cycles / per_us), (unsigned long)((cycles % per_us) * 10 / per_us));
+}
+
+void BENCH::report(const char *name, uint32_t period_us) {
+	qsort(samples, frames, sizeof(uint32_t), cmpCycles);
+	uint32_t per_us = benchCyclesPerUs();
+	if (!per_us) per_us = 1;
+	char mn[24], md[24], p99[24], mx[24], line[160];
+	printUs(mn,  sizeof(mn),  samples[0],											per_us);
+	printUs(md,  sizeof(md),  samples[frames >> 1],									per_us);
+	printUs(p99, sizeof(p99), samples[(uint32_t(frames) * 99 + 99) / 100 - 1],		per_us);
+	printUs(mx,  sizeof(mx),  samples[frames - 1],									per_us);
+	snprintf(line, sizeof(line), "%s,%u,%u,%lu,%s,%s,%s,%s,%lu,%lu", name, strip.numPixels(), frames,
+			(unsigned long)period_us, mn, md, p99, mx, (unsigned long)(reads / frames), (unsigned long)(writes / frames));
+	benchPrint(line);
+}
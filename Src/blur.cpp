@@ -0,0 +1,110 @@
+#include "blur.h"
+
+// The LED bytes as the packed color. The byte order does not matter: every byte is blurred separately
+static inline COLOR loadLED(const uint8_t *p, uint8_t bytes) {
+	COLOR c = p[0] | (COLOR(p[1]) << 8) | (COLOR(p[2]) << 16);
+	if (bytes > 3) c |= COLOR(p[3]) << 24;
+	return c;
+}
+
+static inline void storeLED(uint8_t *p, uint8_t bytes, COLOR c) {
+	p[0] = c;
+	p[1] = c >> 8;
+	p[2] = c >> 16;
+	if (bytes > 3) p[3] = c >> 24;
+}
+
+// The first LED of the view range in the canvas. Returns the range length, 0 if the canvas can not be blurred
+static uint16_t blurRange(uint8_t* &first, uint8_t &bytes) {
+	if (strip.isIndexed()) return 0;
+	PIXEL_SURFACE v	= strip.getView();
+	uint8_t *canvas	= strip.getCanvas();
+	bytes			= strip.bytesPerLED();
+	first			= canvas + v.offset * bytes;
+	if (canvas == strip.getData())
+		strip.waitTransfer();
+	return v.length;
+}
+
+/*
+ * The sliding window average. The window sum of the bytes 0 and 2 is in rb, the bytes 1 and 3 are in wg,
+ * 16 bits per byte is enough for 33 pixels. fn(original, average) returns the new pixel color.
+ */
+template <typename F>
+static void boxWalk(uint8_t radius, F fn) {
+	uint8_t *first, bytes;
+	uint16_t n = blurRange(first, bytes);
+	if (n < 2 || radius == 0) return;
+	if (radius > BLUR::max_radius) radius = BLUR::max_radius;
+	if (radius >= n) radius = n - 1;
+
+	const COLOR m	= 0x00FF00FF;
+	COLOR	ring[BLUR::max_radius + 1];									// The original colors of the pixels i-radius ... i
+	uint32_t rcp	= (0x10000UL + 2 * radius) / (2 * radius + 1);		// The reciprocal of the window width, rounded up
+	COLOR	c0		= loadLED(first, bytes);
+	COLOR	c_last	= loadLED(first + (n - 1) * bytes, bytes);
+	uint32_t rb		= (c0 & m) * (radius + 1);							// The pixels -radius ... 0
+	uint32_t wg		= ((c0 >> 8) & m) * (radius + 1);
+	for (uint8_t k = 1; k <= radius; ++k) {
+		COLOR c = loadLED(first + k * bytes, bytes);
+		rb += c & m;
+		wg += (c >> 8) & m;
+	}
+
+	uint8_t *p	= first;
+	uint8_t	 ri	= 0;													// The ring position of the pixel i
+	for (uint16_t i = 0; i < n; ++i, p += bytes) {
+		COLOR orig	= loadLED(p, bytes);
+		ring[ri]	= orig;
+		COLOR avg	= ((((rb & 0xFFFF) * rcp) >> 16))		| ((((wg & 0xFFFF) * rcp) >> 16) << 8) |
+					  ((((rb >> 16) * rcp) >> 16) << 16)	| ((((wg >> 16) * rcp) >> 16) << 24);
+		storeLED(p, bytes, fn(orig, avg));
+		if (++ri > radius) ri = 0;										// Now the position of the pixel i-radius
+		uint16_t j	= i + radius + 1;									// The pixel entering the window, not blurred yet
+		COLOR add	= (j < n)?loadLED(first + j * bytes, bytes):c_last;
+		COLOR rem	= (i >= radius)?ring[ri]:c0;						// The pixel leaving the window
+		rb += (add & m) - (rem & m);									// The lanes never get negative: rem is in the sum
+		wg += ((add >> 8) & m) - ((rem >> 8) & m);
+	}
+	strip.bufferChanged(strip.getCanvas());
+}
+
+void BLUR::box(uint8_t radius) {
+	boxWalk(radius, [](COLOR, COLOR avg) { return avg; });
+}
+
+// Three box passes of the radius r are close to the gaussian with sigma = sqrt(r*(r+1))
+void BLUR::gauss(uint8_t radius) {
+	for (uint8_t pass = 0; pass < 3; ++pass)
+		box(radius);
+}
+
+// The original picture plus the blurred one scaled by gain, the bright pixels get the halo
+void BLUR::glow(uint8_t radius, uint8_t gain) {
+	boxWalk(radius, [gain](COLOR orig, COLOR avg) { return clrAdd(orig, nscale8(avg, gain)); });
+}
+
+/*
+ * Every pixel keeps 255-amount of its color and gives amount/2 to each neighbor.
+ * The pixel is written when the part of its right neighbor is known, so one pixel is kept in the register only
+ */
+void BLUR::blur1d(uint8_t amount) {
+	uint8_t *first, bytes;
+	uint16_t n = blurRange(first, bytes);
+	if (n < 2 || amount == 0) return;
+	uint8_t keep	= 255 - amount;
+	uint8_t seep	= amount >> 1;
+	COLOR	carry	= 0;												// The part of the previous pixel
+	COLOR	prev	= 0;												// The previous pixel without the part of the current one
+	uint8_t *p		= first;
+	for (uint16_t i = 0; i < n; ++i, p += bytes) {
+		COLOR cur	= loadLED(p, bytes);
+		COLOR part	= nscale8(cur, seep);
+		if (i > 0)
+			storeLED(p - bytes, bytes, clrAdd(prev, part));
+		prev		= clrAdd(nscale8(cur, keep), carry);
+		carry		= part;
+	}
+	storeLED(p - bytes, bytes, prev);
+	strip.bufferChanged(strip.getCanvas());
+}
@@ -1,32 +1,17 @@
 #include "clean.h"
+#include "clrmath.h"
 
 //---------------------------------------------- Classes for strip clearing  ----------------------------------------------
 bool clr::fadeAll(uint8_t val) {
-	bool finish = true;
-	for (uint16_t i = 0; i < strip.numPixels(); ++i) {
-		if (!fade(i, val)) finish = false;
-	}
-	return finish;
+	return strip.subtractAll(val);
 }
 
 bool clr::fade(uint16_t index, uint8_t val) {
-	COLOR c = strip.getPixelColor(index);
-	uint8_t bound = 0;
-	for (int8_t s = 16; s >= 0; s -= 8) {
-		int32_t cc = c >> s;										// The color component (red, green or blue)
-		cc &= 0xff;
-		cc -= int(val);
-		if (cc < 0) {
-			cc = 0;
-			bound ++;
-		}
-		uint32_t mask = 0xff; mask <<= s; mask = ~mask;
-		cc <<= s;
-		c &= mask;
-		c |= cc;
-	}
-	strip.setPixelColor(index, c);
-	return (bound >= 3);
+	COLOR c 	= strip.getPixelColor(index);
+	COLOR v		= val * 0x010101;										// Decrement red, green and blue components
+	bool  done	= (clrLess(c, v) & 0xFFFFFF) == 0xFFFFFF;				// All the components become zero
+	strip.setPixelColor(index, clrSub(c, v));
+	return done;
 }
 
 bool clr::isComplete(void) {
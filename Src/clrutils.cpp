@@ -1,4 +1,5 @@
 #include "clrutils.h"
+#include "clrmath.h"
 #include "ws2811b_cpp.h"
 
 
@@ -22,51 +23,24 @@ void CRAWL::step(void) {
 
 //---------------------------------------------- Brightness manipulation --------------------------------------------------
 void BRGTN::setColor(COLOR c) {
-	color[0] = c & 0xff;	c >>= 8;									// Blue
-	color[1] = c & 0xff;	c >>= 8;									// Green
-	color[2] = c & 0xff;												// Red
+	color = c & 0xFFFFFF;												// Red, Green, Blue
 }
 
 bool BRGTN::changeClr(COLOR& c, int8_t val) {
-	COLOR	new_color	= 0;
-	uint8_t	bound		= 0;
-
 	if (val < 0) {														// Decrement color
 		if (c == 0)														// Cannot decrement zero color
 			return true;
-		int16_t  e = 256 + val;
-		for (uint8_t i = 0; i < 3; ++i) {
-			int32_t cc = c & 0xff; c >>= 8;								// Color component value (b, g, r)
-			int32_t new_cc = cc * e; new_cc >>= 8;						// New color component = (cc * e) / 256;
-			if (new_cc == cc) {											// For small COLOR component value use addition instead of multiplication
-				cc += val;
-			} else {
-				cc = new_cc;
-			}
-			if (cc <= 0) {
-				cc = 0;
-				++bound;
-			}
-			new_color >>= 8;
-			cc <<= 16; new_color |= cc;									// Build new color by shift the components from left to right
-		}
-	} else {															// Increment color
-		for (uint8_t i = 0; i < 3; ++i) {
-			int16_t e = (color[i] * val) >> 8;
-			if (e == 0) e = 1;
-			int32_t cc = c & 0xff; c >>= 8;								// Color component value (b, g, r)
-			cc += e;
-			if (cc >= color[i]) {										// Limit component value by the component of the preset color
-				cc = color[i];
-				++bound;
-			}
-			new_color >>= 8;
-			cc <<= 16; new_color |= cc;									// Build new color by shift the components from left to right
-		}
+		COLOR cc		= c & 0xFFFFFF;
+		COLOR new_cc	= nscale8(cc, 255 + val);						// New color component = (cc * (256 + val)) / 256;
+		COLOR small		= clrEqual(new_cc, cc);							// For small COLOR component value use addition instead of multiplication
+		c = (new_cc & ~small) | (clrSub(cc, uint8_t(-val) * 0x010101) & small);
+		return (c == 0);
 	}
-
-	c = new_color;
-	return (bound >= 3);
+																		// Increment color
+	COLOR e = clrScale(color, val);										// The increment of each component
+	e |= clrEqual(e, 0) & 0x010101;										// Increment component at least by 1
+	c = clrMin(clrAdd(c & 0xFFFFFF, e), color);							// Limit component value by the component of the preset color
+	return (c == color);
 }
 
 bool BRGTN::change(uint16_t index, int8_t val) {
@@ -76,7 +50,10 @@ bool BRGTN::change(uint16_t index, int8_t val) {
 	return done;
 }
 
+// The decrement is the same as changeClr() made by the driver on the buffer bytes, the black pixels are skipped
 bool BRGTN::changeAll(int8_t val) {
+	if (val < 0)
+		return strip.fade(255 + val, -val);
 	bool finish = true;
 	for (uint16_t i = 0; i < strip.numPixels(); ++i) {
 		COLOR c = strip.getPixelColor(i);
@@ -88,41 +65,11 @@ bool BRGTN::changeAll(int8_t val) {
 
 //---------------------------------------------- Blend manipulations ------------------------------------------------------
 COLOR BLEND::add(COLOR color1, COLOR color2) {
-	uint8_t r1,g1,b1;
-	uint8_t r2,g2,b2;
-
-	r1 = (uint8_t)(color1 >> 16);
-	g1 = (uint8_t)(color1 >>  8);
-	b1 = (uint8_t)(color1 >>  0);
-
-	r2 = (uint8_t)(color2 >> 16);
-	g2 = (uint8_t)(color2 >>  8);
-	b2 = (uint8_t)(color2 >>  0);
-
-	return strip.Color(constrain(r1+r2, 0, 255), constrain(g1+g2, 0, 255), constrain(b1+b2, 0, 255));
+	return clrAdd(color1, color2) & 0xFFFFFF;
 }
 
 COLOR BLEND::sub(COLOR color1, COLOR color2) {
-	uint8_t r1,g1,b1;
-	uint8_t r2,g2,b2;
-	int16_t r,g,b;
-
-	r1 = (uint8_t)(color1 >> 16);
-	g1 = (uint8_t)(color1 >>  8);
-	b1 = (uint8_t)(color1 >>  0);
-
-	r2 = (uint8_t)(color2 >> 16);
-	g2 = (uint8_t)(color2 >>  8);
-	b2 = (uint8_t)(color2 >>  0);
-
-	r  = (int16_t)r1 - (int16_t)r2;
-	g  = (int16_t)g1 - (int16_t)g2;
-	b =  (int16_t)b1 - (int16_t)b2;
-	if (r < 0) r = 0;
-	if (g < 0) g = 0;
-	if (b < 0) b = 0;
-
-	return strip.Color(r, g, b);
+	return clrSub(color1, color2) & 0xFFFFFF;
 }
 
 void BLEND::blendPixel(uint16_t p, uint8_t deviation) {
@@ -140,44 +87,55 @@ void BLEND::blendPixel(uint16_t p, uint8_t deviation) {
 	strip.setPixelColor(p, blended_color);
 }
 
+//---------------------------------------------- Sub-pixel rendering -----------------------------------------------------
+// The dot of one pixel size: two neighbor pixels share the intensity
+void SUBPIXEL::dot(uint32_t pos, COLOR c) {
+	uint16_t n		= pos >> 8;
+	uint16_t frac	= pos & 0xFF;
+	addPixel(n,   c, 256 - frac);
+	addPixel(n+1, c, frac);
+}
+
+// The segment [pos, pos+len): the end pixels get the part of the intensity, inner pixels get the whole color
+void SUBPIXEL::segment(uint32_t pos, uint32_t len, COLOR c) {
+	uint32_t end	= pos + len;
+	uint16_t first	= pos >> 8;
+	uint16_t last	= end >> 8;
+	if (first == last) {
+		addPixel(first, c, len);
+		return;
+	}
+	addPixel(first, c, 256 - (pos & 0xFF));
+	for (uint16_t n = first + 1; n < last; ++n)
+		addPixel(n, c, 256);
+	addPixel(last, c, end & 0xFF);
+}
+
+// Add the color scaled by the pixel coverage (0...256) to the pixel
+void SUBPIXEL::addPixel(uint16_t n, COLOR c, uint16_t cover) {
+	if (cover == 0 || n >= strip.numPixels()) return;
+	strip.setPixelColor(n, clrAdd(strip.getPixelColor(n), clrScale(c, cover)));
+}
+
 //---------------------------------------------- Color superposition class ------------------------------------------------
 COLOR TWOCLR::add(COLOR c1, COLOR c2) {
-	COLOR c = 0;
-	for (uint8_t i = 0; i < 3; ++i) {
-		uint32_t p = c1 >> (i*8);
-		p += c2 >> (i*8);
-		p &= 0xff;
-		p <<= i*8;
-		c |= p;
-	}
-	return c;
+	return clrAddWrap(c1, c2) & 0xFFFFFF;								// The component overflow is lost
 }
 
 //---------------------------------------------- The sine wave value class ------------------------------------------------
 uint8_t	WAVE::amplitude(uint8_t n) {
-	n &= 0x3F;															// The sin(PI*n/32) period is 64
-	if (n >= 32) {
-		n -= 32;
-		if (n > 16)
-			return 254 - sine[32-n];
-		else
-			return 254 - sine[n];
-	} else {
-		if (n > 16)
-			return sine[32-n];
-		else
-			return sine[n];
-	}
+	return 127 + sin8(n << 2);											// The sin(PI*n/32) period is 64
+}
+
+uint16_t WAVE::amplitude16(uint16_t phase) {
+	return 32767 + sin16(phase);
 }
 
 COLOR	WAVE::intencity(COLOR c, uint8_t n) {
-	COLOR res = 0;
-	for (uint8_t i = 0; i < 3; ++i) {									// Get the color components: b, g, r
-		res >>= 8;
-		uint32_t cc = c & 0xFF;	c >>= 8;
-		cc *= amplitude(n);
-		cc /= 254;
-		cc <<= 16; res |= cc;
-	}
-	return res;
+	uint8_t amp = amplitude(n);											// 0...254
+	return nscale8(c, amp + (amp >> 7)) & 0xFFFFFF;						// Scale the amplitude to 0...255 range, c * amp / 254
+}
+
+COLOR	WAVE::intencity16(COLOR c, uint16_t phase) {
+	return nscale8(c, amplitude16(phase) >> 8) & 0xFFFFFF;
 }
@@ -0,0 +1,145 @@
+#include "compositor.h"
+#include <stdlib.h>
+
+//---------------------------------------------- Layer blending kernels, process the buffers word by word -----------------
+static void layerCopy(uint32_t *out, const uint32_t *src, uint16_t words, uint8_t alpha) {
+	if (alpha == 255) {
+		for (uint16_t i = 0; i < words; ++i) out[i] = src[i];
+	} else {
+		for (uint16_t i = 0; i < words; ++i) out[i] = nscale8(src[i], alpha);
+	}
+}
+
+static void layerAdd(uint32_t *out, const uint32_t *src, uint16_t words, uint8_t alpha) {
+	if (alpha == 255) {
+		for (uint16_t i = 0; i < words; ++i) out[i] = clrAdd(out[i], src[i]);
+	} else {
+		for (uint16_t i = 0; i < words; ++i) out[i] = clrAdd(out[i], nscale8(src[i], alpha));
+	}
+}
+
+static void layerMax(uint32_t *out, const uint32_t *src, uint16_t words, uint8_t alpha) {
+	if (alpha == 255) {
+		for (uint16_t i = 0; i < words; ++i) out[i] = clrMax(out[i], src[i]);
+	} else {
+		for (uint16_t i = 0; i < words; ++i) out[i] = clrMax(out[i], nscale8(src[i], alpha));
+	}
+}
+
+static void layerAlpha(uint32_t *out, const uint32_t *src, uint16_t words, uint8_t alpha) {
+	for (uint16_t i = 0; i < words; ++i) out[i] = clrLerp(out[i], src[i], alpha + (alpha >> 7));
+}
+
+static void layerMultiply(uint32_t *out, const uint32_t *src, uint16_t words, uint8_t alpha) {
+	for (uint16_t i = 0; i < words; ++i) {
+		uint32_t mask = src[i];
+		if (alpha != 255) mask = clrLerp(0xFFFFFFFF, mask, alpha);	// Transparent mask keeps the output
+		out[i] = clrMul(out[i], mask);
+	}
+}
+
+//---------------------------------------------- The layered compositor ---------------------------------------------------
+// If keep_output is true, the layer starts with the current strip data, so the animation running on the strip can continue in the layer
+bool COMPOSITOR::addLayer(animation* a, LAYER_MODE mode, uint8_t alpha, bool keep_output) {
+	if (active >= max_layers) return false;
+	for (uint8_t i = 0; i < active; ++i)							// The animation cannot draw in two layers at once
+		if (l[i].a == a) return false;
+	uint16_t size = strip.bufferSize();
+	if (size > buff_size[active]) {									// The strip is longer than the one the buffer was allocated for
+		free(buff[active]);
+		buff[active]		= (uint8_t *)malloc(size);
+		buff_size[active]	= buff[active]?size:0;
+		if (!buff[active]) return false;
+	}
+	l[active].a		= a;
+	l[active].buff	= buff[active];
+	l[active].period= 0;
+	l[active].mode	= mode;
+	l[active].alpha	= alpha;
+	if (keep_output) {
+		strip.waitTransfer();
+		layerCopy((uint32_t *)l[active].buff, (uint32_t *)strip.getData(), strip.bufferSize() >> 2, 255);
+		strip.bufferChanged(l[active].buff);
+	} else {
+		strip.setCanvas(l[active].buff);
+		strip.clear();
+		strip.setCanvas(0);
+	}
+	++active;
+	return true;
+}
+
+// Initialize the animations in their layers, select the random step period of each animation
+void COMPOSITOR::init(void) {
+	for (uint8_t i = 0; i < active; ++i)
+		initLayer(i);
+}
+
+void COMPOSITOR::initLayer(uint8_t layer) {
+	if (layer >= active) return;
+	strip.setCanvas(l[layer].buff);
+	l[layer].a->init();												// Initialization procedure can change period parameters (min_p & max_p)
+	strip.setCanvas(0);
+	uint16_t min_stp = uint16_t(l[layer].a->min_p) * 10;
+	uint16_t max_stp = uint16_t(l[layer].a->max_p) * 10;
+	l[layer].period	= Random(min_stp, max_stp) + 1;
+	l[layer].a->resetTime();
+}
+
+void COMPOSITOR::setPeriod(uint8_t layer, uint16_t period) {
+	if (layer < active) l[layer].period = period;
+}
+
+void COMPOSITOR::setAlpha(uint8_t layer, uint8_t alpha) {
+	if (layer < active && l[layer].alpha != alpha) {
+		l[layer].alpha	= alpha;
+		dirty			= true;
+	}
+}
+
+// Advance every animation to the time ms. Returns true if the output has been updated
+bool COMPOSITOR::show(uint32_t ms) {
+	bool changed = dirty;
+	for (uint8_t i = 0; i < active; ++i) {
+		if (stepLayer(i, ms))
+			changed = true;
+	}
+	if (changed) compose();
+	return changed;
+}
+
+// Combine the layers into the strip data array
+void COMPOSITOR::compose(void) {
+	dirty = false;
+	if (active == 0) return;
+	uint32_t *out	= (uint32_t *)strip.getData();
+	uint16_t words	= strip.bufferSize() >> 2;
+	strip.waitTransfer();											// Do not change the data while it is being transferred
+	layerCopy(out, (uint32_t *)l[0].buff, words, l[0].alpha);
+	for (uint8_t i = 1; i < active; ++i) {
+		const uint32_t *src = (uint32_t *)l[i].buff;
+		switch (l[i].mode) {
+			case LAYER_MAX:
+				layerMax(out, src, words, l[i].alpha);
+				break;
+			case LAYER_ALPHA:
+				layerAlpha(out, src, words, l[i].alpha);
+				break;
+			case LAYER_MULTIPLY:
+				layerMultiply(out, src, words, l[i].alpha);
+				break;
+			case LAYER_ADD:
+			default:
+				layerAdd(out, src, words, l[i].alpha);
+				break;
+		}
+	}
+	strip.bufferChanged();
+}
+
+bool COMPOSITOR::stepLayer(uint8_t layer, uint32_t ms) {
+	strip.setCanvas(l[layer].buff);
+	bool changed = l[layer].a->advance(ms, l[layer].period);
+	strip.setCanvas(0);
+	return changed;
+}
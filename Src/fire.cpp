@@ -0,0 +1,51 @@
+#include "fire.h"
+#include <stdlib.h>
+
+// Prepare the flames of height cells each, all the cells are cold
+bool FIRE::init(uint8_t flames, uint16_t height) {
+	if (flames == 0) flames = 1;
+	if (height == 0) height = 1;
+	uint16_t size = uint16_t(flames) * height;
+	if (size > allocated) {
+		free(h);
+		h = (uint8_t *)malloc(size);
+		allocated = h?size:0;
+	}
+	if (!h) {
+		num_flames	= 0;
+		cells		= 0;
+		return false;
+	}
+	num_flames	= flames;
+	cells		= height;
+	for (uint16_t i = 0; i < size; ++i) h[i] = 0;
+	seed		= rand();
+	return true;
+}
+
+void FIRE::step(void) {
+	if (cells == 0) return;
+	uint16_t cool = (uint16_t(cooling) * 10) / cells + 2;			// The maximum cooling of the cell per step
+	if (cool > 255) cool = 255;
+	uint8_t spark_cells = (cells < 7)?cells:7;
+	for (uint8_t f = 0; f < num_flames; ++f) {
+		uint8_t *c = &h[uint16_t(f) * cells];
+
+		// Cool down every cell a little
+		for (uint16_t i = 0; i < cells; ++i) {
+			uint8_t d = random8(cool);
+			c[i] = (c[i] > d)?c[i] - d:0;
+		}
+
+		// The heat drifts up and diffuses: the average of the two cells below, the farther one counts twice as in Fire2012
+		for (uint16_t i = cells - 1; i >= 2; --i)
+			c[i] = ((c[i-1] + 2 * c[i-2]) * 683) >> 11;				// (x * 683) >> 11 is x / 3 for x <= 765
+
+		// Randomly ignite new spark near the origin
+		if (random8() < sparking) {
+			uint8_t y	= random8(spark_cells);
+			uint16_t t	= c[y] + 160 + random8(96);
+			c[y]		= (t > 255)?255:t;
+		}
+	}
+}
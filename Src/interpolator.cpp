@@ -0,0 +1,66 @@
+#include "interpolator.h"
+#include <stdlib.h>
+
+// Start interpolation of the animation drawn on the strip. The buffers are allocated once
+bool INTERPOLATOR::start(void) {
+	uint16_t size = strip.bufferSize();
+	if (size > allocated) {											// The strip is longer than the one the buffers were allocated for
+		free(key);
+		free(prev);
+		key			= (uint8_t *)malloc(size);
+		prev		= (uint8_t *)malloc(size);
+		allocated	= (key && prev)?size:0;
+	}
+	if (!allocated) return false;
+	strip.waitTransfer();
+	const uint32_t *data = (uint32_t *)strip.getData();
+	for (uint16_t i = 0; i < (size >> 2); ++i) {					// The animation continues with the current strip data
+		((uint32_t *)key)[i]	= data[i];
+		((uint32_t *)prev)[i]	= data[i];
+	}
+	strip.bufferChanged(key);
+	key_ms	= HAL_GetTick();
+	frac	= 256;
+	on		= true;
+	return true;
+}
+
+// Stop the interpolation, the strip gets the last keyframe, so the animation can continue on the strip directly
+void INTERPOLATOR::stop(void) {
+	if (!on) return;
+	on = false;
+	strip.waitTransfer();
+	uint32_t *data = (uint32_t *)strip.getData();
+	for (uint16_t i = 0; i < (strip.bufferSize() >> 2); ++i)
+		data[i] = ((uint32_t *)key)[i];
+	strip.bufferChanged();
+}
+
+// Advance the animation in the keyframe, mix the output. Returns true if the output has been changed
+bool INTERPOLATOR::show(animation* a, uint32_t ms, uint16_t period) {
+	uint32_t	*data	= (uint32_t *)strip.getData();
+	uint16_t	words	= strip.bufferSize() >> 2;
+	strip.setCanvas(key);
+	bool step = a->advance(ms, period);
+	strip.setCanvas(0);
+	if (step) {														// New keyframe: mix from the current output to it
+		strip.waitTransfer();
+		for (uint16_t i = 0; i < words; ++i)
+			((uint32_t *)prev)[i] = data[i];
+		key_ms	= ms;
+		frac	= 0;
+	}
+
+	if (period == 0) period = 1;
+	uint32_t f = ((ms - key_ms) << 8) / period;
+	if (f > 256) f = 256;
+	if (f == frac) return false;									// The output is the same
+	frac = f;
+	strip.waitTransfer();
+	const uint32_t *p = (uint32_t *)prev;
+	const uint32_t *k = (uint32_t *)key;
+	for (uint16_t i = 0; i < words; ++i)
+		data[i] = clrLerp(p[i], k[i], frac);
+	strip.bufferChanged();
+	return true;
+}
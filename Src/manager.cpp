@@ -29,35 +29,46 @@ void shuffle::randomize(void) {
 }
 
 // --------------------------------------------- The sequence manager -----------------------------------------------------
-MANAGER::MANAGER(MAX7219 *disp, animation* a[], uint8_t a_size, clr* c[], uint8_t clr_size) : shuffle(a_size) {
+MANAGER::MANAGER(MAX7219 *disp, animation* a[], uint8_t a_size, clr* c[], uint8_t clr_size, animation* o[], uint8_t o_size) : shuffle(a_size) {
 	dsp				= disp;
 	anims			= a;
     clearance		= c;
     num_clr			= clr_size;
+    overlays		= o;
+    num_overlays	= o_size;
     stp				= 0;
     do_clear		= false;
     aIndex			= 0;
 }
 
 void MANAGER::init(void) {
-	if (!anims[aIndex]->do_clear) {
-		aIndex = shuffle::next();
-//		aIndex = 45;
-		a = anims[aIndex];
-
-		uint32_t period = a->show_time;
-		period = Random(period, period * 3);						// time in 10-seconds intervals
-		period *= 10000;											// Now time in ms
-		next = HAL_GetTick() + period;
-	}
+	if (!anims[aIndex]->do_clear)
+		nextAnimation();
 
 	a = anims[aIndex];
+	a_layer = 0;
+	ip.stop();
+	strip.setIndexed(0);											// The next animation draws in colors
 	strip.clear();
-	a->init();														// Initialization procedure can change period parameters (min_p & max_p)
-	uint16_t min_stp = uint16_t(a->min_p) * 10;
-	uint16_t max_stp = uint16_t(a->max_p) * 10;
-	stp_period = Random(min_stp, max_stp) + 1;						// If a->min_p == 0, ensure the step period is greater than 0
+	cmp.clear();
+	zn.clear();
+	choosePalette();
+	if (num_overlays && Random(4) == 0) {							// Run the overlay animation on top of the main one
+		animation *o = overlays[Random(num_overlays)];
+		if (!cmp.addLayer(a, LAYER_ADD) || !cmp.addLayer(o, LAYER_MAX))
+			cmp.clear();											// Not enough memory or the same animation
+	}
+	if (cmp.layers())
+		cmp.init();
+	else if (Random(4) == 0 && initZones())
+		zn.init();
+	else
+		a->init();													// Initialization procedure can change period parameters (min_p & max_p)
+	a->resetTime();
+	setStepPeriod();
 	stp = 0;
+	if (!cmp.layers() && !zn.zones() && stp_period >= interp_period)
+		ip.start();													// The slow animation runs smoothly
 
 	decimal(aIndex);
 	dsp->setChar(0, 'A', true);
@@ -65,41 +76,132 @@ void MANAGER::init(void) {
 	a->do_clear = false;
 }
 
+void MANAGER::nextAnimation(void) {
+	aIndex = shuffle::next();
+//	aIndex = 45;
+	a = anims[aIndex];
+
+	uint32_t period = a->show_time;
+	period = Random(period, period * 3);							// time in 10-seconds intervals
+	period *= 10000;												// Now time in ms
+	next = HAL_GetTick() + period;
+}
+
+void MANAGER::setStepPeriod(void) {
+	uint16_t min_stp = uint16_t(a->min_p) * 10;
+	uint16_t max_stp = uint16_t(a->max_p) * 10;
+	stp_period = Random(min_stp, max_stp) + 1;						// If a->min_p == 0, ensure the step period is greater than 0
+	updatePeriod();
+}
+
+/*
+ * Split the strip into two zones: the current animation runs in the first half of the strip and the random one
+ * runs in the second half. The second half is reversed, so both animations start at the ends of the strip.
+ * The spatial animations (the tree and the matrix ones) address the physical LEDs, they cannot run in the zone
+ */
+bool MANAGER::initZones(void) {
+	if (a->spatial) return false;
+	uint8_t num	= shuffle::size();
+	uint8_t k	= Random(num);
+	for (uint8_t i = 0; i < num && (anims[k]->spatial || anims[k] == a); ++i)
+		if (++k >= num) k = 0;										// The next 1D animation
+	animation* s = anims[k];
+	if (s->spatial) return false;
+	uint16_t half = strip.numPixels() >> 1;
+	if (zn.addZone(a, 0, half) && zn.addZone(s, half, strip.numPixels() - half, VIEW_REVERSE))
+		return true;
+	zn.clear();														// The same animation selected
+	return false;
+}
+
 void MANAGER::show(void) {
 	uint32_t ms = HAL_GetTick();
-	if (!do_clear && (ms > next) && a->complete) {					// The current animation is timed out
+	blendPalette(ms);
+	if (do_fade) {
+		fade(ms);
+		return;
+	}
+
+	bool complete = zn.zones()?zn.complete():a->complete;			// All the zone animations have to complete the sequence
+	if (!do_clear && (ms > next) && complete) {						// The current animation is timed out
 		if (isClean())
 			init();
+		else if (fade_time && !zn.zones() && Random(2))				// The zone animations cannot continue in the layer
+			initFade();
 		else
 			initClear();
 	}
 
-	if (ms < stp) {													// It is not time for next step, return
-		return;
-	}
-
-	if (do_clear)
-		stp = ms + clr_stp_period;
-	else
-		stp = ms + stp_period;
-
 	if (do_clear) {
+		if (ms < stp) {												// It is not time for next step, return
+			return;
+		}
+		stp = ms + clr_stp_period;
 		if (c->isComplete()) {
 			do_clear = false;
 			if (ms > next) a->do_clear = false;						// It is too late to continue the animation
 			init();
 		} else
 			c->show();												// Keep running clear session till it ends
-	} else {
-		if (a->do_clear) initClear();
-		a->show();
+		output(ms);
+		return;
+	}
+
+	if (a->do_clear) {
+		initClear();
+		return;
 	}
+
+	bool changed = false;
+	if (cmp.layers())												// The animations are running in layers, each one with its own period
+		changed = cmp.show(ms);
+	else if (zn.zones())											// The animations are running in zones, each one with its own period
+		changed = zn.show(ms);
+	else if (ip.active())
+		changed = ip.show(a, ms, stp_period);
+	else
+		changed = a->advance(ms, stp_period);
+	if (changed)
+		output(ms);
+}
+
+// Send the data to the strip, measure the frame rate
+void MANAGER::output(uint32_t ms) {
 	strip.show();
+	++frames;
+	uint32_t elapsed = ms - fps_start;
+	if (elapsed >= 1000) {
+		fps			= (frames * 1000 + (elapsed >> 1)) / elapsed;
+		frames		= 0;
+		fps_start	= ms;
+		if (show_fps) {
+			decimal(fps);
+			dsp->setChar(0, 'H', true);
+		}
+	}
+}
+
+// Switch between the animation number and the frame rate on the display
+void MANAGER::switchFPS(void) {
+	show_fps = !show_fps;
+	if (show_fps) {
+		decimal(fps);
+		dsp->setChar(0, 'H', true);
+	} else {
+		decimal(aIndex);
+		dsp->setChar(0, 'A', true);
+	}
 }
 
 
 void MANAGER::initClear(void) {
+	ip.stop();
+	strip.setIndexed(0);											// The clearing sequence works on the colors
 	do_clear = true;												// Start clearing sequence
+	do_fade	 = false;
+	cmp.clear();													// The clearing sequence works on the strip directly
+	zn.clear();
+	a_layer	 = 0;
 	uint8_t ni = Random(num_clr);
 	c = clearance[ni];
 	c->init();
@@ -109,10 +211,95 @@ void MANAGER::initClear(void) {
 	dsp->setChar(0, 'C', true);
 }
 
+/*
+ * Start the crossfade: the current animation keeps running in the layer 0, the next one starts in the layer 1
+ * and it is mixed over the current one with increasing alpha. Two layer buffers are used at most.
+ */
+void MANAGER::initFade(void) {
+	ip.stop();														// The current animation continues from its last frame
+	strip.setIndexed(0);											// The layers keep the colors
+	if (cmp.layers())
+		cmp.truncate(1);											// The current animation is in the layer 0 already, drop the overlay
+	else if (cmp.addLayer(a, LAYER_ADD, 255, true))					// Continue the current animation from the strip data
+		cmp.setPeriod(0, stp_period);
+	else {
+		initClear();
+		return;
+	}
+
+	animation* o = a;
+	nextAnimation();
+	if (a == o || !cmp.addLayer(a, LAYER_ALPHA, 0)) {				// The animation cannot run in two layers
+		a->do_clear = true;											// Start the selected animation after the clearing
+		initClear();
+		return;
+	}
+	a_layer = 1;
+	cmp.initLayer(a_layer);
+	setStepPeriod();
+	do_fade		= true;
+	fade_start	= HAL_GetTick();
+
+	decimal(aIndex);
+	dsp->setChar(0, 'F', true);
+	a->do_clear = false;
+}
+
+void MANAGER::fade(uint32_t ms) {
+	uint32_t elapsed = ms - fade_start;
+	if (elapsed < fade_time) {
+		cmp.setAlpha(a_layer, ease8InOutSine(elapsed * 255 / fade_time));
+		if (cmp.show(ms)) output(ms);
+		return;
+	}
+
+	cmp.setAlpha(a_layer, 255);										// The next animation covers the strip completely
+	cmp.compose();
+	animation* o = cmp.layerAnimation(0);
+	if (o) o->do_clear = false;										// The clearing request of the finished animation is not relevant
+	cmp.clear();													// The next animation continues on the strip data
+	a_layer	= 0;
+	do_fade	= false;
+	if (stp_period >= interp_period)
+		ip.start();													// The slow animation runs smoothly as after init()
+	dsp->setChar(0, 'A', true);
+	output(ms);
+}
+
+/*
+ * The animations use the color wheel or the random palette. The palette slowly blends to the random gradient,
+ * then the next gradient is selected. The animations pick the new colors from the changing palette
+ */
+void MANAGER::choosePalette(void) {
+	const PALETTE* p = 0;
+	pal_target = 0;
+	if (Random(3) == 0) {
+		uint8_t ni	= Random(num_gradients + num_palettes16);
+		bool loaded	= (ni < num_gradients)?palette.load(gradients[ni]):palette.load16(palettes16[ni - num_gradients]);
+		if (loaded) {
+			p			= &palette;
+			pal_target	= gradients[Random(num_gradients)];
+		}
+	}
+	for (uint8_t i = 0; i < shuffle::size(); ++i)
+		anims[i]->setPalette(p);
+	for (uint8_t i = 0; i < num_overlays; ++i)
+		overlays[i]->setPalette(p);
+}
+
+void MANAGER::blendPalette(uint32_t ms) {
+	if (!pal_target || int32_t(ms - pal_next) < 0) return;
+	pal_next = ms + pal_period;
+	if (strip.isIndexed())
+		strip.waitTransfer();										// The DMA reads the palette colors of the indexed strip
+	if (palette.blendToward(pal_target, 1))
+		pal_target = gradients[Random(num_gradients)];
+	if (strip.isIndexed())
+		strip.bufferChanged();										// The palette colors of the indexed strip have been changed
+}
+
 bool MANAGER::isClean(void) {
-	for (uint16_t i = 0; i < strip.numPixels(); ++i)
-		if (strip.getPixelColor(i)) return false;
-	return true;
+	return strip.isDark();
 }
 
 void MANAGER::decimal(uint16_t value) {
@@ -0,0 +1,98 @@
+#include "matrix.h"
+#include <stdlib.h>
+
+// Build the index table of the standard layout. The table is allocated once and reused if the panel size is not increased
+bool MATRIX::init(uint8_t width, uint8_t height, MATRIX_LAYOUT layout) {
+	uint16_t size = uint16_t(width) * height;
+	if (size > own_size) {
+		free(own_map);
+		own_size	= 0;
+		own_map		= (uint16_t *)malloc(size * sizeof(uint16_t));
+		if (!own_map) {
+			map = 0; w = h = 0;
+			return false;
+		}
+		own_size	= size;
+	}
+
+	for (uint8_t y = 0; y < height; ++y) {
+		for (uint8_t x = 0; x < width; ++x) {
+			uint16_t index = 0;
+			switch (layout) {
+				case MATRIX_SERPENTINE:
+					index = uint16_t(y) * width + ((y & 1)?(width - 1 - x):x);
+					break;
+				case MATRIX_COLUMNS:
+					index = uint16_t(x) * height + y;
+					break;
+				case MATRIX_SERP_COLUMNS:
+					index = uint16_t(x) * height + ((x & 1)?(height - 1 - y):y);
+					break;
+				case MATRIX_ROWS:
+				default:
+					index = uint16_t(y) * width + x;
+					break;
+			}
+			own_map[uint16_t(y) * width + x] = index;
+		}
+	}
+	map	= own_map;
+	w	= width;
+	h	= height;
+	return true;
+}
+
+// Use the custom index table of width * height entries
+bool MATRIX::init(uint8_t width, uint8_t height, const uint16_t *custom_map) {
+	if (!custom_map) return false;
+	map	= custom_map;
+	w	= width;
+	h	= height;
+	return true;
+}
+
+// Limit the rectangle by the panel borders. Returns false if the rectangle is outside of the panel
+bool MATRIX::clip(int16_t& x, int16_t& y, int16_t& width, int16_t& height) {
+	if (x < 0) { width  += x; x = 0; }
+	if (y < 0) { height += y; y = 0; }
+	if (x + width  > w) width  = w - x;
+	if (y + height > h) height = h - y;
+	return (width > 0) && (height > 0);
+}
+
+void MATRIX::fillRect(int16_t x, int16_t y, int16_t width, int16_t height, COLOR c) {
+	if (!clip(x, y, width, height)) return;
+	for (int16_t j = y; j < y + height; ++j) {
+		const uint16_t *row = &map[uint16_t(j) * w];
+		for (int16_t i = x; i < x + width; ++i)
+			strip.setPixelColor(row[i], c);
+	}
+}
+
+// Bresenham's line, the pixels outside of the panel are skipped
+void MATRIX::line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, COLOR c) {
+	int16_t dx	=  abs(x1 - x0);
+	int16_t dy	= -abs(y1 - y0);
+	int8_t  sx	= (x0 < x1)?1:-1;
+	int8_t  sy	= (y0 < y1)?1:-1;
+	int16_t err	= dx + dy;
+	while (true) {
+		setPixel(x0, y0, c);
+		if (x0 == x1 && y0 == y1) break;
+		int16_t e2 = err << 1;
+		if (e2 >= dy) { err += dy; x0 += sx; }
+		if (e2 <= dx) { err += dx; y0 += sy; }
+	}
+}
+
+// Copy the image of width * height colors (row by row) to the panel, the top left corner is (x, y)
+void MATRIX::blit(int16_t x, int16_t y, uint8_t width, uint8_t height, const COLOR *src) {
+	int16_t cx = x, cy = y, cw = width, ch = height;
+	if (!clip(cx, cy, cw, ch)) return;
+	for (int16_t j = 0; j < ch; ++j) {
+		const COLOR		*s		= &src[uint16_t(cy - y + j) * width + (cx - x)];
+		const uint16_t	*row	= &map[uint16_t(cy + j) * w + cx];
+		for (int16_t i = 0; i < cw; ++i)
+			strip.setPixelColor(row[i], s[i]);
+	}
+}
@@ -0,0 +1,48 @@
+#include "noise.h"
+
+// The smoothstep curve 3f^2 - 2f^3, f is the fraction of the cell 0...255
+static inline uint8_t fade8(uint8_t f) {
+	uint32_t ff = uint32_t(f) * f;
+	return (ff * (768 - 2 * uint32_t(f))) >> 16;
+}
+
+static inline uint8_t lerp8(uint8_t a, uint8_t b, uint8_t frac) {
+	return a + ((int16_t(b - a) * frac) >> 8);
+}
+
+// One-dimensional noise, the noise of the time for example
+uint8_t noise8(uint16_t x) {
+	const NOISE_PERM& p = noisePerm();
+	uint8_t xi = x >> 8;
+	return lerp8(p[xi], p[uint8_t(xi + 1)], fade8(x & 0xFF));
+}
+
+// Two-dimensional noise, noise8(position, time) changes smoothly along the strip and in time
+uint8_t noise8(uint16_t x, uint16_t y) {
+	const NOISE_PERM& p = noisePerm();
+	uint8_t xi	= x >> 8;
+	uint8_t yi	= y >> 8;
+	uint8_t fx	= fade8(x & 0xFF);
+	uint8_t fy	= fade8(y & 0xFF);
+	uint8_t a	= p[xi];
+	uint8_t b	= p[uint8_t(xi + 1)];
+	uint8_t v0	= lerp8(p[uint8_t(a + yi)],		p[uint8_t(b + yi)],		fx);
+	uint8_t v1	= lerp8(p[uint8_t(a + yi + 1)],	p[uint8_t(b + yi + 1)],	fx);
+	return lerp8(v0, v1, fy);
+}
+
+/*
+ * The sum of the octaves with the weights 1/2, 1/4, ... The last octave gets the weight of the previous one,
+ * so the weights sum up to 1. Every octave is shifted, so the lattice points of the octaves do not match
+ */
+uint8_t fractal8(uint16_t x, uint16_t y, uint8_t octaves) {
+	if (octaves <= 1) return noise8(x, y);
+	uint16_t sum = 0;
+	for (uint8_t o = 1; o < octaves; ++o) {
+		sum += noise8(x, y) >> o;
+		x = (x << 1) + 0x3A7B;
+		y = (y << 1) + 0x51C9;
+	}
+	sum += noise8(x, y) >> (octaves - 1);
+	return (sum > 255)?255:sum;
+}
@@ -0,0 +1,130 @@
+#include "palette.h"
+#include <stdlib.h>
+
+//---------------------------------------------- Built-in palettes, placed in the flash memory ----------------------------
+const uint32_t grad_rainbow[] = {
+	0x00FF0000, 0x2BFFFF00, 0x5500FF00, 0x8000FFFF, 0xAA0000FF, 0xD5FF00FF, 0xFFFF0000
+};
+
+const uint32_t grad_heat[] = {
+	0x00000000, 0x50800000, 0x90FF2000, 0xC8FFA000, 0xFFFFFFC0
+};
+
+const uint32_t grad_ocean[] = {
+	0x00000020, 0x40000080, 0x800040C0, 0xC000A0C0, 0xE040E0FF, 0xFF000040
+};
+
+const uint32_t grad_forest[] = {
+	0x00002000, 0x50006400, 0x9055A020, 0xC0A0C000, 0xFF005000
+};
+
+const uint32_t grad_sunset[] = {
+	0x00780000, 0x16B31600, 0x33FF6800, 0x55A71601, 0x87640067, 0xC610008C, 0xFF000080
+};
+
+// The meteor colors from the head to the tail
+const uint32_t grad_meteor[] = {
+	0x00FFB844, 0x24FCFF96, 0x48FDFFCE, 0x6DFFFFFF, 0x91FFB540, 0xB6FE9E4A, 0xDAE65634, 0xFF91182B
+};
+
+const uint32_t*	const gradients[] = { grad_rainbow, grad_heat, grad_ocean, grad_forest, grad_sunset };
+const uint8_t	num_gradients = sizeof(gradients) / sizeof(uint32_t *);
+
+const COLOR pal16_party[16] = {
+	0x5500AB, 0x84007C, 0xB5004B, 0xE5001B, 0xE81700, 0xB84700, 0xAB7700, 0xABAB00,
+	0xAB5500, 0xDD2200, 0xF2000E, 0xC2003E, 0x8F0071, 0x5F00A1, 0x2F00D0, 0x0007F9
+};
+
+const COLOR pal16_lava[16] = {
+	0x000000, 0x800000, 0x000000, 0x800000, 0x8B0000, 0x800000, 0x8B0000, 0x8B0000,
+	0x8B0000, 0xFF0000, 0xFFA500, 0xFFFFFF, 0xFFA500, 0xFF0000, 0x8B0000, 0x000000
+};
+
+const COLOR*	const palettes16[] = { pal16_party, pal16_lava };
+const uint8_t	num_palettes16 = sizeof(palettes16) / sizeof(COLOR *);
+
+//---------------------------------------------- The gradient interpolation ---------------------------------------------
+/*
+ * Walk the gradient from index 0 to 255, call fn(index, color) for every index.
+ * The fraction of the segment is accumulated in 1/65536 units, so one division is made per segment only
+ */
+template <typename F>
+static void gradientWalk(const uint32_t *gradient, F fn) {
+	COLOR	 c0	= gradient[0] & 0xFFFFFF;
+	uint16_t i	= 0;
+	for (uint16_t i0 = gradient[0] >> 24; i < i0; ++i)				// The colors before the first key color
+		fn(uint8_t(i), c0);
+	while (i < 255) {
+		uint16_t i1	= *++gradient >> 24;
+		COLOR	 c1	= *gradient & 0xFFFFFF;
+		if (i1 <= i) {												// The broken gradient, fill up the table with the last color
+			for ( ; i < 255; ++i) fn(uint8_t(i), c0);
+			break;
+		}
+		uint32_t rcp	= 0x1000000UL / (i1 - i);					// The fraction step, 1/65536 of the segment
+		uint32_t frac	= 0;
+		for ( ; i < i1; ++i) {
+			fn(uint8_t(i), clrLerp(c0, c1, frac >> 16));
+			frac += rcp;
+		}
+		c0 = c1;
+	}
+	fn(255, c0);
+}
+
+// The color of the gradient palette. Useful to get several colors without the palette table
+COLOR colorFromGradient(const uint32_t *gradient, uint8_t index, uint8_t brightness) {
+	COLOR c = gradient[0] & 0xFFFFFF;
+	if (index > (gradient[0] >> 24)) {
+		while (index > (gradient[1] >> 24) && (gradient[1] >> 24) > (gradient[0] >> 24))
+			++gradient;
+		uint8_t i0 = gradient[0] >> 24;
+		uint8_t i1 = gradient[1] >> 24;
+		if (i1 > i0)
+			c = clrLerp(gradient[0] & 0xFFFFFF, gradient[1] & 0xFFFFFF, (uint16_t(index - i0) << 8) / (i1 - i0));
+		else
+			c = gradient[0] & 0xFFFFFF;
+	}
+	return (brightness == 255)?c:nscale8(c, brightness);
+}
+
+//---------------------------------------------- The palette table --------------------------------------------------------
+bool PALETTE::alloc(void) {
+	if (!lut)
+		lut = (COLOR *)malloc(256 * sizeof(COLOR));
+	return lut != 0;
+}
+
+// Expand the gradient palette to the table
+bool PALETTE::load(const uint32_t *gradient) {
+	if (!alloc()) return false;
+	COLOR *t = lut;
+	gradientWalk(gradient, [t](uint8_t i, COLOR c) { t[i] = c; });
+	return true;
+}
+
+// Expand the 16-entry palette to the table
+bool PALETTE::load16(const COLOR *pal16) {
+	if (!alloc()) return false;
+	for (uint16_t i = 0; i < 256; ++i)
+		lut[i] = ::colorFromPalette(pal16, i);
+	return true;
+}
+
+/*
+ * Move every color component of the table toward the gradient color by change at most.
+ * The target colors are computed on the fly, no second table is required. Returns true when the target is reached
+ */
+bool PALETTE::blendToward(const uint32_t *gradient, uint8_t change) {
+	if (!lut) return load(gradient);
+	COLOR	*t		= lut;
+	COLOR	 chg	= COLOR(change) * 0x01010101;
+	COLOR	 diff	= 0;
+	gradientWalk(gradient, [t, chg, &diff](uint8_t i, COLOR c) {
+		COLOR up	= clrMin(clrSub(c, t[i]), chg);
+		COLOR down	= clrMin(clrSub(t[i], c), chg);
+		t[i]		= clrSub(clrAdd(t[i], up), down);
+		diff	   |= t[i] ^ c;
+	});
+	return diff == 0;
+}
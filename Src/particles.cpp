@@ -0,0 +1,78 @@
+#include "particles.h"
+#include <stdlib.h>
+
+/*
+ * Prepare the pool for capacity particles on the current strip (view), kill all the particles.
+ * The arrays are allocated once and reallocated only if they are too small.
+ * If the memory is not enough, the capacity is limited by the pool allocated before
+ */
+bool PARTICLES::init(uint16_t capacity) {
+	num		= 0;
+	if (capacity == 0) capacity = 1;
+	if (capacity > allocated) {										// The old pool is released when the new one is ready
+		uint16_t *n_pos		= (uint16_t *)malloc(capacity * sizeof(uint16_t));
+		uint16_t *n_aux		= (uint16_t *)malloc(capacity * sizeof(uint16_t));
+		COLOR	 *n_color	= (COLOR *)malloc(capacity * sizeof(COLOR));
+		int8_t	 *n_vel		= (int8_t *)malloc(capacity);
+		uint8_t	 *n_age		= (uint8_t *)malloc(capacity);
+		if (n_pos && n_aux && n_color && n_vel && n_age) {
+			free(pos); free(aux); free(color); free(vel); free(age);
+			pos = n_pos; aux = n_aux; color = n_color; vel = n_vel; age = n_age;
+			allocated = capacity;
+		} else {
+			free(n_pos); free(n_aux); free(n_color); free(n_vel); free(n_age);
+		}
+	}
+	cap		= (capacity < allocated)?capacity:allocated;
+
+	uint16_t n		= strip.numPixels();
+	uint16_t words	= (n + 31) >> 5;
+	if (words > map_words) {
+		free(map);
+		map			= (uint32_t *)malloc(words * sizeof(uint32_t));
+		map_words	= (map)?words:0;
+	}
+	length	= (map)?n:0;
+	clearMap();
+	return cap > 0;
+}
+
+void PARTICLES::clear(void) {
+	num = 0;
+	clearMap();
+}
+
+// Add the new particle at the end of the pool. Returns the particle index or -1 if the pool is full
+int16_t PARTICLES::spawn(uint16_t p, COLOR c, int8_t v, uint16_t a) {
+	if (num >= cap) return -1;
+	pos[num]	= p;
+	aux[num]	= a;
+	color[num]	= c;
+	vel[num]	= v;
+	age[num]	= 0;
+	mark(p);
+	return num++;
+}
+
+// Remove the particle outside of the update pass. The pixel becomes free even if other particle stays there
+void PARTICLES::kill(uint16_t i) {
+	if (i >= num) return;
+	uint16_t p = pos[i];
+	if (p < length) map[p >> 5] &= ~(uint32_t(1) << (p & 31));
+	remove(i);
+}
+
+// Move the last particle to the entry i
+void PARTICLES::remove(uint16_t i) {
+	if (--num == i) return;
+	pos[i]		= pos[num];
+	aux[i]		= aux[num];
+	color[i]	= color[num];
+	vel[i]		= vel[num];
+	age[i]		= age[num];
+}
+
+void PARTICLES::clearMap(void) {
+	uint16_t words = (length + 31) >> 5;
+	for (uint16_t w = 0; w < words; ++w) map[w] = 0;
+}
@@ -8,9 +8,14 @@
 #include "max7219_cpp.h"
 #include "tools.h"
 #include "animation.h"
+#include "animation2d.h"
+#include "animation3d.h"
 #include "clean.h"
 #include "manager.h"
 #include "button.h"
+#ifdef BENCHMARK
+#include "bench.h"
+#endif
 
 // These variables are defined in main.c
 extern	ADC_HandleTypeDef hadc1;
@@ -19,6 +24,13 @@ extern	DMA_HandleTypeDef hdma_tim2_ch1;
 extern	SPI_HandleTypeDef hspi1;
 //-----------------------------------------
 
+// Uncomment to run the animations on the 2D LED panel made of serpentine strip
+//#define LED_MATRIX
+#ifdef LED_MATRIX
+const uint8_t	matrix_width	= 16;
+const uint8_t	matrix_height	= 16;
+#endif
+
 // Animations
 colorWipe   cWipe;
 colorWalk   cWalk;
@@ -57,15 +69,28 @@ solCreep    sCreep;
 theatChase	tChase;
 meteorSky	mtrSky;
 symmRun		symRun;
-metSingle	mtrSgl;
+metSingle	mtrSgl(true);
 pureStrip	pStrip;
 sideFill	sFill;
-browMotion	cBrowian;
+browMotion	cBrowian(true);
 rainDrops	cRainDrp;
 ripeFruit	cRipe;
 brightWave	bWave;
 brColCreep	bcCreep;
 dropFade	cFadeDrp;
+treeSweep	tSweep;
+treeBeam	tBeam;
+treePulse	tPulse;
+treeFire	tFire;
+lavaLamp	nLava;
+aurora		nAurora;
+candles		nCandles;
+#ifdef LED_MATRIX
+mxRainDrops	mxRain;
+mxRainbow	mxRnbw;
+mxLines		mxLine;
+mxBoxes		mxBox;
+#endif
 
 // Clear animations
 clearSide   clrSide;
@@ -79,20 +104,47 @@ animation*  anims[] = {
               &cCollEnd, &cRun, 	&cSeven,	&mOne,		&mWave,			&cOne,		&cFire,		&cEvenOdd,	&rFill,		&cCollMdl,
               &cBlend,	 &cSwing,	&cSwingS,	&cFlash,	&sWave,			&cWorms,	&cInterf,	&cToward,	&rToward,	&lHouse,
               &cDrops,	 &wSeven, 	&fSeven, 	&sCreep,	&tChase,		&mtrSky,	&symRun,	&mtrSgl,	&pStrip,	&sFill,
-			  &cBrowian, &cRainDrp, &cRipe,		&bWave,		&bcCreep,		&cFadeDrp
+			  &cBrowian, &cRainDrp, &cRipe,		&bWave,		&bcCreep,		&cFadeDrp,		&tSweep,	&tBeam,		&tPulse,
+			  &tFire,	 &nLava,	&nAurora,	&nCandles
+#ifdef LED_MATRIX
+			  , &mxRain, &mxRnbw,	&mxLine,	&mxBox
+#endif
             };
 clr*        clearance[] = { &clrSide, &clrCntr, &clrFade, &clrEat, &clrHalf };
 
+// Animations that can run on top of the main animation
+animation*	overlays[]	= { &sRnd, &rFade, &mtrSky };
+
 const uint8_t  num_anim = sizeof(anims) / sizeof(animation*);
 const uint8_t  num_clr  = sizeof(clearance) / sizeof(clr*);
+const uint8_t  num_ovrl = sizeof(overlays) / sizeof(animation*);
 
 
+#ifdef LED_MATRIX
+const uint16_t	strip_length = uint16_t(matrix_width) * matrix_height;
+#else
 const uint16_t	strip_length = 100;
+#endif
 NEOPIXEL		strip;												// Global variable used in many files
+MATRIX			matrix;												// The 2D panel mapping, used by 2D animations
+TREE3D			tree;												// The LED coordinates, used by spatial animations
+
+/*
+ * The LED coordinates of the tree. Define TREE_MAP_FILE as the name of the file with measured coordinates:
+ * strip_length lines of { height, angle, radius }, entries. Otherwise the string is a spiral around the cone
+ */
+#ifdef TREE_MAP_FILE
+static const LED_POS tree_map[strip_length] = {
+#include TREE_MAP_FILE
+};
+#else
+static constexpr TREE_SPIRAL<strip_length, 8> tree_spiral;
+static const LED_POS* const tree_map = tree_spiral.map();
+#endif
 BUTTON			bMenu(BTN_MENU_GPIO_Port, BTN_MENU_Pin);
 BUTTON			bIncr(BTN_PLUS_GPIO_Port, BTN_PLUS_Pin);
 MAX7219			disp(&hspi1, SPI1_SS_GPIO_Port, SPI1_SS_Pin);
-MANAGER     	mgr(&disp, anims, num_anim, clearance, num_clr);
+MANAGER     	mgr(&disp, anims, num_anim, clearance, num_clr, overlays, num_ovrl);
 
 extern "C" void DMA1_Channel5_IRQHandler(void) {
 	strip.DMA_CallBack();
@@ -112,11 +164,51 @@ extern "C" void EXTI3_IRQHandler(void) {
 	}
 }
 
+#ifdef BENCHMARK
+/*
+ * Measure the animations and the drawing primitives instead of showing them, the CSV report goes to the SWO output.
+ * The strip lengths that do not fit the memory are skipped
+ */
+static const uint16_t	bench_max_leds	= 1000;
+static const uint16_t	bench_lengths[]	= { 100, 300, bench_max_leds };
+static const uint16_t	bench_frames	= 100;
+static constexpr TREE_SPIRAL<bench_max_leds, 8> bench_tree;		// In the flash, the 3D animations cover the whole strip
+BENCH					bench;
+
+void setup(void) {
+	benchClockStart();
+	disp.init();
+	if (!bench.init(bench_frames)) return;
+	bench.header();
+	for (uint8_t l = 0; l < sizeof(bench_lengths) / sizeof(uint16_t); ++l) {
+		uint16_t leds = bench_lengths[l];
+		strip.release();
+		strip.init(leds, &htim2, TIM_CHANNEL_1, &hdma_tim2_ch1, NEO_RGB);
+		if (strip.numPixels() != leds) {
+			benchPrint("# not enough memory");
+			continue;
+		}
+		tree.init(bench_tree.map(), leds);
+		bench.animations(anims, num_anim);
+		bench.kernels();
+	}
+	strip.release();
+	strip.init(strip_length, &htim2, TIM_CHANNEL_1, &hdma_tim2_ch1, NEO_RGB);
+	strip.show();
+}
+
+void loop(void) { }
+
+#else
 void setup(void) {
 	uint32_t light 	= analogRead(&hadc1, ADC_CHANNEL_3);			// The ambient light
 	srand(light);													// Initialize random generator with the ambient light value
 	strip.init(strip_length, &htim2, TIM_CHANNEL_1, &hdma_tim2_ch1, NEO_RGB);
 	strip.show();
+	tree.init(tree_map, strip_length);
+#ifdef LED_MATRIX
+	matrix.init(matrix_width, matrix_height, MATRIX_SERPENTINE);
+#endif
 	disp.init();
 	mgr.init();
 	HAL_Delay(500);
@@ -130,6 +222,10 @@ void loop(void) {
 	  else if (bStatus == 2)
 		  mgr.menu_l();
 	  bStatus = bIncr.intButtonStatus();
-	  if (bStatus) mgr.incr();
+	  if (bStatus == 1)
+		  mgr.incr();
+	  else if (bStatus == 2)
+		  mgr.incr_l();
 
 }
+#endif
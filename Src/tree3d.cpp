@@ -0,0 +1,47 @@
+#include "tree3d.h"
+
+// The number of LEDs having coordinates in the current strip view
+uint16_t TREE3D::numPixels(void) {
+	uint16_t n = strip.numPixels();
+	return (n < leds)?n:leds;
+}
+
+/*
+ * The fall-off factor of the shape of the given width: the intensity decreases from 255 to 0 at the width distance.
+ * Compute it once per frame, so the per-LED intensity requires no division
+ */
+uint16_t TREE3D::falloff(uint8_t width) {
+	if (width == 0) width = 1;
+	return 65535 / width;
+}
+
+uint8_t TREE3D::intensity(uint16_t distance, uint16_t fall) {
+	uint32_t d = (uint32_t(distance) * fall) >> 8;
+	return (d >= 255)?0:(255 - d);
+}
+
+// The horizontal plane at the level height
+uint8_t TREE3D::plane(uint16_t n, uint8_t level, uint16_t fall) {
+	return intensity(abs(int16_t(pos[n].h) - level), fall);
+}
+
+// The vertical half-plane rotating around the trunk, the direction is the angle of the beam
+uint8_t TREE3D::beam(uint16_t n, uint8_t direction, uint16_t fall) {
+	int8_t d = pos[n].a - direction;								// The angle difference wraps around the full turn
+	return intensity(abs(d), fall);
+}
+
+// The sphere surface of the radius with center in (cx, cy, ch)
+uint8_t TREE3D::sphere(uint16_t n, int8_t cx, int8_t cy, uint8_t ch, uint16_t radius, uint16_t fall) {
+	uint16_t d[3] = { uint16_t(abs(x(n) - cx)), uint16_t(abs(y(n) - cy)), uint16_t(abs(int16_t(pos[n].h) - ch)) };
+	for (uint8_t i = 0; i < 2; ++i) {								// Sort the components: d[0] is the maximum one
+		if (d[i] < d[i+1]) {
+			uint16_t t = d[i]; d[i] = d[i+1]; d[i+1] = t;
+		}
+	}
+	if (d[0] < d[1]) {
+		uint16_t t = d[0]; d[0] = d[1]; d[1] = t;
+	}
+	uint16_t dist = d[0] + (((d[1] + d[2]) * 11) >> 5);			// The Euclidean distance approximation, error is less than 10%
+	return intensity(abs(int16_t(dist) - radius), fall);
+}
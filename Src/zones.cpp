@@ -0,0 +1,63 @@
+#include "zones.h"
+
+bool ZONES::addZone(animation* a, uint16_t offset, uint16_t length, uint8_t flags) {
+	if (active >= max_zones || length == 0) return false;
+	for (uint8_t i = 0; i < active; ++i)							// The animation cannot run in two zones at once
+		if (z[i].a == a) return false;
+	z[active].a				= a;
+	z[active].view.offset	= offset;
+	z[active].view.length	= length;
+	z[active].view.flags	= flags;
+	z[active].period		= 0;
+	++active;
+	return true;
+}
+
+// Initialize the animations in their zones, select the random step period of each animation
+void ZONES::init(void) {
+	for (uint8_t i = 0; i < active; ++i) {
+		strip.setView(&z[i].view);
+		strip.clear();
+		z[i].a->init();												// Initialization procedure can change period parameters (min_p & max_p)
+		strip.setView(0);
+		uint16_t min_stp = uint16_t(z[i].a->min_p) * 10;
+		uint16_t max_stp = uint16_t(z[i].a->max_p) * 10;
+		z[i].period	= Random(min_stp, max_stp) + 1;
+		z[i].a->resetTime();
+		z[i].a->do_clear = false;									// The request of the previous run is stale
+	}
+}
+
+void ZONES::setPeriod(uint8_t zone, uint16_t period) {
+	if (zone < active) z[zone].period = period;
+}
+
+/*
+ * Advance every animation to the time ms. Returns true if the strip has been changed.
+ * The animation that asks for clearing starts again in its zone. The manager clears the whole strip
+ * for the animation of the first zone before this call
+ */
+bool ZONES::show(uint32_t ms) {
+	bool changed = false;
+	for (uint8_t i = 0; i < active; ++i) {
+		strip.setView(&z[i].view);
+		if (z[i].a->do_clear) {
+			strip.clear();
+			z[i].a->init();
+			z[i].a->do_clear = false;
+			z[i].a->resetTime();
+			changed = true;
+		}
+		if (z[i].a->advance(ms, z[i].period))
+			changed = true;
+		strip.setView(0);
+	}
+	return changed;
+}
+
+// Whether every animation can be changed to the next one
+bool ZONES::complete(void) {
+	for (uint8_t i = 0; i < active; ++i)
+		if (!z[i].a->complete) return false;
+	return true;
+}